@@ -34,18 +34,86 @@ ANIMATIONS
 */
 
 #include <iostream>
+#include <string>
 #include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <memory>
+
+#ifndef _MSC_VER
+// İskelet dosyalarının belleğe eşlenmesi (mmap)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #ifdef __APPLE__
 #define GL_SILENCE_DEPRECATION
+#include <OpenGL/OpenGL.h>
 #include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
 #include <GLUT/glut.h>
+// Eski (2.1) bağlamda VAO'lar APPLE eklentisiyle gelir
+#define glGenVertexArrays glGenVertexArraysAPPLE
+#define glBindVertexArray glBindVertexArrayAPPLE
+#define glDeleteVertexArrays glDeleteVertexArraysAPPLE
+// Örnekli (instanced) çizim de ARB eklentileriyle gelir
+#define glVertexAttribDivisor glVertexAttribDivisorARB
+#define glDrawElementsInstanced glDrawElementsInstancedARB
+#define glDrawArraysInstanced glDrawArraysInstancedARB
+// GPU zamanlayıcı sorguları EXT_timer_query ile gelir
+#define GL_TIME_ELAPSED GL_TIME_ELAPSED_EXT
+#define glGetQueryObjectui64v glGetQueryObjectui64vEXT
+// Ekran dışı çizim (framebuffer nesneleri) EXT_framebuffer_object ile gelir
+#define GL_FRAMEBUFFER GL_FRAMEBUFFER_EXT
+#define GL_FRAMEBUFFER_BINDING GL_FRAMEBUFFER_BINDING_EXT
+#define GL_FRAMEBUFFER_COMPLETE GL_FRAMEBUFFER_COMPLETE_EXT
+#define GL_RENDERBUFFER GL_RENDERBUFFER_EXT
+#define GL_COLOR_ATTACHMENT0 GL_COLOR_ATTACHMENT0_EXT
+#define GL_DEPTH_ATTACHMENT GL_DEPTH_ATTACHMENT_EXT
+#define glGenFramebuffers glGenFramebuffersEXT
+#define glBindFramebuffer glBindFramebufferEXT
+#define glDeleteFramebuffers glDeleteFramebuffersEXT
+#define glCheckFramebufferStatus glCheckFramebufferStatusEXT
+#define glFramebufferTexture2D glFramebufferTexture2DEXT
+#define glFramebufferRenderbuffer glFramebufferRenderbufferEXT
+#define glGenRenderbuffers glGenRenderbuffersEXT
+#define glBindRenderbuffer glBindRenderbufferEXT
+#define glDeleteRenderbuffers glDeleteRenderbuffersEXT
+#define glRenderbufferStorage glRenderbufferStorageEXT
+#define glGenerateMipmap glGenerateMipmapEXT
 #elif _MSC_VER
+// Windows'ta OpenGL 1.1 sonrası fonksiyonlar GLEW ile yüklenir
+#include <glew.h>
 #include <glut.h>
 #else
+#define GL_GLEXT_PROTOTYPES
 #include <GL/gl.h>
+#include <GL/glext.h>
 #include <GL/glut.h>
+#ifdef __linux__
+// Dikey eşitleme (--fps=vsync) için GLX'in takas aralığı eklentileri
+#include <GL/glx.h>
+// Penceresiz çizim (--headless) için EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#define HEADLESS_EGL
+#endif
 #endif
 
 /////////////////////////////////////////////////////////////////// SABİTLER
@@ -59,6 +127,18 @@ ANIMATIONS
 #define CYLINDER 1
 #define RECTANGULARPRISM 2
 
+// Küre ve silindirlerin kaç dilim/katman ile üçgenleneceği
+
+#define SPHERE_SLICES 128
+#define SPHERE_STACKS 128
+#define CYLINDER_SLICES 64
+#define CYLINDER_STACKS 64
+
+// Ekranda küçük görünen cisimler için daha az dilimli
+// ayrıntı seviyeleri (LOD). 0. seviye yukarıdaki değerlerdir.
+
+#define LOD_LEVELS 4
+
 // Object sınıfıyla bir vücut parçası
 
 #define ROOT_OBJECT true
@@ -87,6 +167,605 @@ typedef struct rgba
     double red, green, blue, alpha;
 } RGBA;
 
+/////////////////////////////////////////////////////////////////// MATRİS
+
+/*
+Matrix4, OpenGL'in matris yığınında tuttuğu dönüşümlerin CPU
+tarafındaki karşılığıdır. Değerler OpenGL'in beklediği gibi
+sütun öncelikli (column-major) sırada saklanır, böylece
+glUniformMatrix4fv'e doğrudan verilebilir.
+
+glTranslated, glRotated, gluPerspective ve gluLookAt
+çağrılarının ürettiği matrisleri aşağıdaki fonksiyonlar üretir.
+*/
+
+typedef struct matrix4
+{
+    GLfloat m[16];
+} Matrix4;
+
+Matrix4 identityMatrix(void)
+{
+    Matrix4 r = {{1, 0, 0, 0,
+                  0, 1, 0, 0,
+                  0, 0, 1, 0,
+                  0, 0, 0, 1}};
+    return r;
+}
+
+Matrix4 translationMatrix(double x, double y, double z)
+{
+    Matrix4 r = identityMatrix();
+    r.m[12] = x;
+    r.m[13] = y;
+    r.m[14] = z;
+    return r;
+}
+
+Matrix4 scaleMatrix(double x, double y, double z)
+{
+    // glScaled ile aynı matris
+    Matrix4 r = identityMatrix();
+    r.m[0] = x;
+    r.m[5] = y;
+    r.m[10] = z;
+    return r;
+}
+
+Matrix4 rotationMatrix(double degree, int axis)
+{
+    // glRotated(degree, 1, 0, 0) gibi eksenlerden biri etrafında dönme
+    Matrix4 r = identityMatrix();
+    double c = std::cos(degree * PI / 180.0);
+    double s = std::sin(degree * PI / 180.0);
+    int a = (axis + 1) % 3, b = (axis + 2) % 3;
+    r.m[a * 4 + a] = c;
+    r.m[a * 4 + b] = s;
+    r.m[b * 4 + a] = -s;
+    r.m[b * 4 + b] = c;
+    return r;
+}
+
+Matrix4 operator*(const Matrix4 &l, const Matrix4 &r)
+{
+    Matrix4 result;
+    for (int column = 0; column < 4; column++)
+        for (int row = 0; row < 4; row++)
+        {
+            GLfloat sum = 0;
+            for (int k = 0; k < 4; k++)
+                sum += l.m[k * 4 + row] * r.m[column * 4 + k];
+            result.m[column * 4 + row] = sum;
+        }
+    return result;
+}
+
+Matrix4 perspectiveMatrix(double fovy, double aspect, double zNear, double zFar)
+{
+    // gluPerspective ile aynı matris
+    double f = 1.0 / std::tan(fovy * PI / 360.0);
+    Matrix4 r = {{0}};
+    r.m[0] = f / aspect;
+    r.m[5] = f;
+    r.m[10] = (zFar + zNear) / (zNear - zFar);
+    r.m[11] = -1;
+    r.m[14] = 2 * zFar * zNear / (zNear - zFar);
+    return r;
+}
+
+Matrix4 lookAtMatrix(
+    double eyeX, double eyeY, double eyeZ,
+    double centerX, double centerY, double centerZ,
+    double upX, double upY, double upZ)
+{
+    // gluLookAt ile aynı matris
+    double f[3] = {centerX - eyeX, centerY - eyeY, centerZ - eyeZ};
+    double fLength = std::sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    for (int i = 0; i < 3; i++)
+        f[i] /= fLength;
+
+    double s[3] = {f[1] * upZ - f[2] * upY, f[2] * upX - f[0] * upZ, f[0] * upY - f[1] * upX};
+    double sLength = std::sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+    for (int i = 0; i < 3; i++)
+        s[i] /= sLength;
+
+    double u[3] = {s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0]};
+
+    Matrix4 r = identityMatrix();
+    for (int i = 0; i < 3; i++)
+    {
+        r.m[i * 4 + 0] = s[i];
+        r.m[i * 4 + 1] = u[i];
+        r.m[i * 4 + 2] = -f[i];
+    }
+    return r * translationMatrix(-eyeX, -eyeY, -eyeZ);
+}
+
+/////////////////////////////////////////////////////////////////// GÖRÜŞ ALANI
+
+/*
+Frustum, kameranın görebildiği kesik piramidi altı düzlemle tutar.
+Düzlemler projeksiyon * bakış matrisinden çıkarılır (Gribb-Hartmann).
+Bir sınır küresi düzlemlerden herhangi birinin tamamen dışında
+kalıyorsa görünmezdir ve çizilmesine gerek yoktur.
+*/
+
+// Bir kutunun görüş alanına göre durumu (bkz. Frustum::classifyBox)
+#define FRUSTUM_OUTSIDE 0
+#define FRUSTUM_INTERSECTS 1
+#define FRUSTUM_INSIDE 2
+
+class Frustum
+{
+private:
+    // Her düzlem için a, b, c, d (ax + by + cz + d >= 0 içeride)
+    double planes[6][4];
+
+public:
+    Frustum(void)
+    {
+        // set çağrılana kadar her şey görünür kabul edilir
+        for (int i = 0; i < 6; i++)
+        {
+            planes[i][0] = planes[i][1] = planes[i][2] = 0;
+            planes[i][3] = 1;
+        }
+    }
+
+    void set(const Matrix4 &clip)
+    {
+        // Satır 3 +/- satır 0, 1, 2: sol, sağ, alt, üst, yakın, uzak
+        for (int i = 0; i < 6; i++)
+        {
+            int row = i / 2;
+            double sign = i % 2 == 0 ? 1 : -1;
+            double length = 0;
+            for (int k = 0; k < 4; k++)
+            {
+                planes[i][k] = clip.m[k * 4 + 3] + sign * clip.m[k * 4 + row];
+                if (k < 3)
+                    length += planes[i][k] * planes[i][k];
+            }
+            length = std::sqrt(length);
+            for (int k = 0; k < 4; k++)
+                planes[i][k] /= length;
+        }
+    }
+
+    bool containsSphere(Coordinates center, double radius) const
+    {
+        for (int i = 0; i < 6; i++)
+            if (planes[i][0] * center.x + planes[i][1] * center.y + planes[i][2] * center.z + planes[i][3] < -radius)
+                return false;
+        return true;
+    }
+    int classifyBox(const double low[3], const double high[3]) const
+    {
+        // Eksenlere paralel kutu tamamen dışarıda mı, bir düzlemi mi
+        // kesiyor, yoksa tamamen içeride mi
+        int state = FRUSTUM_INSIDE;
+        for (int i = 0; i < 6; i++)
+        {
+            double distance = planes[i][3], extent = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                distance += planes[i][k] * (low[k] + high[k]) / 2;
+                extent += std::fabs(planes[i][k]) * (high[k] - low[k]) / 2;
+            }
+            if (distance < -extent)
+                return FRUSTUM_OUTSIDE;
+            if (distance < extent)
+                state = FRUSTUM_INTERSECTS;
+        }
+        return state;
+    }
+};
+
+/////////////////////////////////////////////////////////////////// UZAMSAL IZGARA
+
+/*
+SpatialGrid, sahnedeki cisimlerin (kalabalığın modelleri, sabit sahnenin
+parçaları) kapsama kürelerini düzgün bir ızgaranın hücrelerine dağıtır.
+Her küre merkezinin düştüğü tek hücreye yazılır (gevşek ızgara);
+yarıçapı yarım hücreden büyük olanlar ayrı bir listede tutulur. Böylece
+bir hücredeki kürelerin hepsi, hücrenin her yönde yarım hücre
+genişletilmiş kutusunun içinde kalır ve sorgular önce bu kutuyu dener:
+görüş alanının tamamen dışındaki hücrelerin cisimlerine bakılmaz,
+tamamen içindekilerinki tek tek denenmez.
+
+Yalnızca dolu hücreler bir hash tablosunda tutulur. Yer değiştiren bir
+cismin yalnızca kendi kaydı güncellenir (hücresi değişmediyse merkezi
+yazılır, değiştiyse iki hücrenin listesine dokunulur); hiçbir işlem
+tüm cisimleri dolaşmaz.
+*/
+
+typedef struct gridItem
+{
+    Coordinates center;
+    double radius;
+
+    // Bulunduğu hücre ve hücrenin (veya büyükler listesinin) içindeki
+    // sırası; kayıtlı değilse slot -1
+    unsigned long long cell;
+    int slot;
+} GridItem;
+
+typedef struct gridCell
+{
+    int x, y, z;
+    std::vector<int> items;
+
+    // Işın sorgusunda hücreye bu sorguda bakılıp bakılmadığı
+    unsigned int visit;
+} GridCell;
+
+// Yarım hücreden büyük cisimlerin hücre anahtarı
+#define GRID_LARGE (~0ULL)
+
+// Hücre koordinatlarının sınırı (anahtarda her eksen 21 bit)
+#define GRID_EXTENT 1048575
+
+class SpatialGrid
+{
+private:
+    double cellSize;
+    std::vector<GridItem> items;
+    std::unordered_map<unsigned long long, GridCell> cells;
+    std::vector<int> large;
+
+    // Şimdiye kadar dolu olmuş hücrelerin sınırları (ışın bu kutuya
+    // kırpılır) ve son ışın sorgusunun numarası
+    int low[3], high[3];
+    unsigned int visit;
+
+    int cellOf(double value) const
+    {
+        double cell = std::floor(value / cellSize);
+        return (int)std::max((double)-GRID_EXTENT, std::min((double)GRID_EXTENT, cell));
+    }
+    static unsigned long long keyOf(int x, int y, int z)
+    {
+        return ((unsigned long long)(x + GRID_EXTENT + 1) << 42) |
+               ((unsigned long long)(y + GRID_EXTENT + 1) << 21) |
+               (unsigned long long)(z + GRID_EXTENT + 1);
+    }
+    unsigned long long keyAt(Coordinates center) const
+    {
+        return keyOf(cellOf(center.x), cellOf(center.y), cellOf(center.z));
+    }
+
+    void place(int id)
+    {
+        GridItem &item = items[id];
+        if (item.radius > cellSize / 2)
+        {
+            item.cell = GRID_LARGE;
+            item.slot = large.size();
+            large.push_back(id);
+            return;
+        }
+
+        int cell[3] = {cellOf(item.center.x), cellOf(item.center.y), cellOf(item.center.z)};
+        item.cell = keyOf(cell[0], cell[1], cell[2]);
+        GridCell &target = cells[item.cell];
+        target.x = cell[0];
+        target.y = cell[1];
+        target.z = cell[2];
+        item.slot = target.items.size();
+        target.items.push_back(id);
+        for (int k = 0; k < 3; k++)
+        {
+            low[k] = std::min(low[k], cell[k]);
+            high[k] = std::max(high[k], cell[k]);
+        }
+    }
+    void unplace(int id)
+    {
+        // Listenin son elemanı cismin yerine taşınır
+        GridItem &item = items[id];
+        std::unordered_map<unsigned long long, GridCell>::iterator found = cells.end();
+        if (item.cell != GRID_LARGE)
+            found = cells.find(item.cell);
+        std::vector<int> &list = item.cell == GRID_LARGE ? large : found->second.items;
+        int last = list.back();
+        list[item.slot] = last;
+        items[last].slot = item.slot;
+        list.pop_back();
+        if (item.cell != GRID_LARGE && list.empty())
+            cells.erase(found);
+        item.slot = -1;
+    }
+
+    void queryBlock(const Frustum &frustum, const int from[3], const int to[3], int state, std::vector<int> &result) const
+    {
+        // Dolu hücrelerin sınırları içindeki hücre bloğu (from..to)
+        // görüş alanıyla denenir: dışarıdaysa hücrelerine bakılmaz,
+        // içerideyse cisimleri denenmeden eklenir, kesişiyorsa uzun
+        // ekseninden ikiye bölünür. Böylece yalnızca görünen hücreler
+        // ve sınırdaki bloklar dolaşılır.
+        if (state != FRUSTUM_INSIDE)
+        {
+            double margin = cellSize / 2;
+            double boxLow[3], boxHigh[3];
+            for (int k = 0; k < 3; k++)
+            {
+                boxLow[k] = from[k] * cellSize - margin;
+                boxHigh[k] = (to[k] + 1) * cellSize + margin;
+            }
+            state = frustum.classifyBox(boxLow, boxHigh);
+            if (state == FRUSTUM_OUTSIDE)
+                return;
+        }
+
+        int axis = 0;
+        for (int k = 1; k < 3; k++)
+            if (to[k] - from[k] > to[axis] - from[axis])
+                axis = k;
+        if (state == FRUSTUM_INTERSECTS && to[axis] > from[axis])
+        {
+            int middle = from[axis] + (to[axis] - from[axis]) / 2;
+            int firstTo[3] = {to[0], to[1], to[2]}, secondFrom[3] = {from[0], from[1], from[2]};
+            firstTo[axis] = middle;
+            secondFrom[axis] = middle + 1;
+            queryBlock(frustum, from, firstTo, state, result);
+            queryBlock(frustum, secondFrom, to, state, result);
+            return;
+        }
+
+        for (int x = from[0]; x <= to[0]; x++)
+            for (int y = from[1]; y <= to[1]; y++)
+                for (int z = from[2]; z <= to[2]; z++)
+                {
+                    std::unordered_map<unsigned long long, GridCell>::const_iterator found = cells.find(keyOf(x, y, z));
+                    if (found == cells.end())
+                        continue;
+                    const std::vector<int> &list = found->second.items;
+                    for (size_t i = 0; i < list.size(); i++)
+                    {
+                        const GridItem &item = items[list[i]];
+                        if (state == FRUSTUM_INSIDE || frustum.containsSphere(item.center, item.radius))
+                            result.push_back(list[i]);
+                    }
+                }
+    }
+    bool touches(int id, Coordinates center, double radius) const
+    {
+        const GridItem &item = items[id];
+        double dx = item.center.x - center.x, dy = item.center.y - center.y, dz = item.center.z - center.z;
+        double reach = item.radius + radius;
+        return dx * dx + dy * dy + dz * dz <= reach * reach;
+    }
+    template <typename Shape>
+    void hit(int id, const double origin[3], const double direction[3], Shape &shape, int &best, double &bestDistance) const
+    {
+        // Işın küreye değiyorsa ilk değme noktasının uzaklığı (ışın
+        // kürenin içinden başlıyorsa 0) en yakından azsa cismin kendi
+        // şekliyle denenir
+        const GridItem &item = items[id];
+        double m[3] = {origin[0] - item.center.x, origin[1] - item.center.y, origin[2] - item.center.z};
+        double b = m[0] * direction[0] + m[1] * direction[1] + m[2] * direction[2];
+        double c = m[0] * m[0] + m[1] * m[1] + m[2] * m[2] - item.radius * item.radius;
+        if (c > 0 && b > 0)
+            return;
+        double discriminant = b * b - c;
+        if (discriminant < 0)
+            return;
+        double distance = std::max(-b - std::sqrt(discriminant), 0.0);
+        if (distance >= bestDistance)
+            return;
+        distance = shape(id, distance);
+        if (distance >= 0 && distance < bestDistance)
+        {
+            best = id;
+            bestDistance = distance;
+        }
+    }
+
+public:
+    SpatialGrid(void)
+    {
+        cellSize = 1;
+        visit = 0;
+        clear();
+    }
+
+    void init(double cellSize)
+    {
+        // Kenarı cellSize olan boş ızgara. Yarıçapı cellSize / 2'den
+        // küçük cisimler hücrelere yazılır; hücre, tipik cismi alacak
+        // en küçük boyda seçilmelidir.
+        this->cellSize = cellSize;
+        clear();
+    }
+    void clear(void)
+    {
+        items.clear();
+        cells.clear();
+        large.clear();
+        for (int k = 0; k < 3; k++)
+        {
+            low[k] = GRID_EXTENT;
+            high[k] = -GRID_EXTENT;
+        }
+    }
+
+    void insert(int id, Coordinates center, double radius)
+    {
+        // id ile anılan cismi (kayıtlıysa eski yerinden alıp) kaydeder;
+        // id'ler çağıranındır ve küçük tutulmalıdır.
+        if (id >= (int)items.size())
+        {
+            GridItem empty = {{0, 0, 0}, 0, GRID_LARGE, -1};
+            items.resize(id + 1, empty);
+        }
+        if (items[id].slot >= 0)
+            unplace(id);
+        items[id].center = center;
+        items[id].radius = radius;
+        place(id);
+    }
+    void move(int id, Coordinates center)
+    {
+        // Kayıtlı cismin yeni merkezi
+        GridItem &item = items[id];
+        if (item.cell == GRID_LARGE || item.cell == keyAt(center))
+        {
+            item.center = center;
+            return;
+        }
+        unplace(id);
+        item.center = center;
+        place(id);
+    }
+    void remove(int id)
+    {
+        if (id < (int)items.size() && items[id].slot >= 0)
+            unplace(id);
+    }
+    bool contains(int id) const
+    {
+        return id < (int)items.size() && items[id].slot >= 0;
+    }
+
+    void queryFrustum(const Frustum &frustum, std::vector<int> &result) const
+    {
+        // Kapsama küresi görüş alanıyla kesişen cisimler (sırasız)
+        result.clear();
+        for (size_t i = 0; i < large.size(); i++)
+            if (frustum.containsSphere(items[large[i]].center, items[large[i]].radius))
+                result.push_back(large[i]);
+        if (cells.empty())
+            return;
+        int from[3] = {low[0], low[1], low[2]}, to[3] = {high[0], high[1], high[2]};
+        queryBlock(frustum, from, to, FRUSTUM_INTERSECTS, result);
+    }
+    void queryRadius(Coordinates center, double radius, std::vector<int> &result) const
+    {
+        // Kapsama küresi verilen küreyle kesişen cisimler (sırasız)
+        result.clear();
+        for (size_t i = 0; i < large.size(); i++)
+            if (touches(large[i], center, radius))
+                result.push_back(large[i]);
+
+        // Kürenin değebileceği hücreler dolu hücrelerden fazlaysa
+        // dolu hücreler dolaşılır.
+        double reach = radius + cellSize / 2;
+        int from[3] = {cellOf(center.x - reach), cellOf(center.y - reach), cellOf(center.z - reach)};
+        int to[3] = {cellOf(center.x + reach), cellOf(center.y + reach), cellOf(center.z + reach)};
+        double range = (to[0] - from[0] + 1.0) * (to[1] - from[1] + 1.0) * (to[2] - from[2] + 1.0);
+        if (range > cells.size())
+        {
+            for (std::unordered_map<unsigned long long, GridCell>::const_iterator it = cells.begin(); it != cells.end(); ++it)
+            {
+                const GridCell &cell = it->second;
+                if (cell.x < from[0] || cell.x > to[0] || cell.y < from[1] || cell.y > to[1] || cell.z < from[2] || cell.z > to[2])
+                    continue;
+                for (size_t i = 0; i < cell.items.size(); i++)
+                    if (touches(cell.items[i], center, radius))
+                        result.push_back(cell.items[i]);
+            }
+            return;
+        }
+        for (int x = from[0]; x <= to[0]; x++)
+            for (int y = from[1]; y <= to[1]; y++)
+                for (int z = from[2]; z <= to[2]; z++)
+                {
+                    std::unordered_map<unsigned long long, GridCell>::const_iterator found = cells.find(keyOf(x, y, z));
+                    if (found == cells.end())
+                        continue;
+                    const std::vector<int> &list = found->second.items;
+                    for (size_t i = 0; i < list.size(); i++)
+                        if (touches(list[i], center, radius))
+                            result.push_back(list[i]);
+                }
+    }
+    template <typename Shape>
+    int raycast(Coordinates origin, Coordinates direction, double maxDistance, Shape shape, double *distance = NULL)
+    {
+        // Işının (origin'den direction yönünde maxDistance'a kadar) ilk
+        // değdiği cisim, yoksa -1. Kapsama küresine değen cisimler için
+        // shape(id, küreye uzaklık) cismin kendi şekline uzaklığı (en az
+        // küreninki kadar) veya değmiyorsa negatif bir değer döndürür;
+        // yalnızca küreler için uzaklığın kendisi döndürülür. Hücreler ışın
+        // boyunca sırayla (3B DDA) komşularıyla birlikte denenir; bir
+        // cismin küresi kendi hücresinin komşularından taşmadığı için
+        // bulunan değme sıradaki hücreden önceyse daha ileri bakılmaz.
+        // (Hücrelere sorgu numarası yazılır; aynı anda tek iş
+        // parçacığından çağrılmalıdır.)
+        double length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        if (length == 0)
+            return -1;
+        double o[3] = {origin.x, origin.y, origin.z};
+        double d[3] = {direction.x / length, direction.y / length, direction.z / length};
+
+        int best = -1;
+        double bestDistance = maxDistance;
+        for (size_t i = 0; i < large.size(); i++)
+            hit(large[i], o, d, shape, best, bestDistance);
+
+        // Işın dolu hücrelerin (yarım hücre genişletilmiş) kutusuna kırpılır
+        double enter = 0, exit = bestDistance;
+        for (int k = 0; k < 3 && !cells.empty(); k++)
+        {
+            double boxLow = low[k] * cellSize - cellSize / 2, boxHigh = (high[k] + 1) * cellSize + cellSize / 2;
+            if (d[k] == 0)
+            {
+                if (o[k] < boxLow || o[k] > boxHigh)
+                    exit = -1;
+                continue;
+            }
+            double t0 = (boxLow - o[k]) / d[k], t1 = (boxHigh - o[k]) / d[k];
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+        }
+
+        if (!cells.empty() && enter <= exit)
+        {
+            visit++;
+            int cell[3], step[3];
+            double next[3], delta[3];
+            for (int k = 0; k < 3; k++)
+            {
+                cell[k] = cellOf(o[k] + d[k] * enter);
+                step[k] = d[k] > 0 ? 1 : (d[k] < 0 ? -1 : 0);
+                if (step[k] == 0)
+                {
+                    next[k] = delta[k] = 1e300;
+                    continue;
+                }
+                next[k] = ((cell[k] + (step[k] > 0 ? 1 : 0)) * cellSize - o[k]) / d[k];
+                delta[k] = cellSize / std::fabs(d[k]);
+            }
+
+            double t = enter;
+            while (t <= exit && t <= bestDistance)
+            {
+                for (int x = cell[0] - 1; x <= cell[0] + 1; x++)
+                    for (int y = cell[1] - 1; y <= cell[1] + 1; y++)
+                        for (int z = cell[2] - 1; z <= cell[2] + 1; z++)
+                        {
+                            std::unordered_map<unsigned long long, GridCell>::iterator found = cells.find(keyOf(x, y, z));
+                            if (found == cells.end() || found->second.visit == visit)
+                                continue;
+                            found->second.visit = visit;
+                            const std::vector<int> &list = found->second.items;
+                            for (size_t i = 0; i < list.size(); i++)
+                                hit(list[i], o, d, shape, best, bestDistance);
+                        }
+
+                int axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+                t = next[axis];
+                next[axis] += delta[axis];
+                cell[axis] += step[axis];
+            }
+        }
+
+        if (distance && best >= 0)
+            *distance = bestDistance;
+        return best;
+    }
+};
+
 /////////////////////////////////////////////////////////////////// KAMERA & IŞIK
 
 /*
@@ -148,6 +827,19 @@ public:
             lookX, lookY, lookZ,
             upZ, upY, upZ);
     }
+    Coordinates getPosition(void)
+    {
+        Coordinates position = {positionX, positionY, positionZ};
+        return position;
+    }
+    Matrix4 viewMatrix(void)
+    {
+        // update metodunun OpenGL'e bildirdiği matrisin CPU'daki karşılığı
+        return lookAtMatrix(
+            positionX, positionY, positionZ,
+            lookX, lookY, lookZ,
+            upZ, upY, upZ);
+    }
 
     void setPosition(double x, double y, double z)
     {
@@ -242,889 +934,6187 @@ public:
         GLfloat light0_pos[] = {light0.x, light0.y, light0.z, 0.0};
         glLightfv(GL_LIGHT0, GL_POSITION, light0_pos);
     }
+    Coordinates getPosition(void)
+    {
+        return light0;
+    }
 };
 
-/////////////////////////////////////////////////////////////////// VÜCUT MODELİ
+/////////////////////////////////////////////////////////////////// ZAMAN
 
-class Object
-{
+/*
+Simülasyon saati duvar saatinden bağımsız, sabit uzunlukta adımlarla
+ilerler. Animasyonlar zamanın kapalı (closed-form) fonksiyonları
+olduğu için her adımda hesap yapılmaz; çizim sırasında son adımla bir
+sonraki arasındaki kesir kadar ileri bir an (ara değer) hesaplanır.
+Böylece çizim hızı değişse de, kareler atlansa da hareket aynı kalır
+ve herhangi bir ana tek hesapla gidilebilir (seek).
+*/
+
+// Saniyedeki simülasyon adımı. Animasyon süreleri (startWalking vb.)
+// bu adımlar cinsinden verilir.
+#define SIMULATION_RATE 60
 
+class SimulationClock
+{
 private:
-    int shape;   //  RECTANGULARPRISM  CYLINDER    SPHERE
-    double dim1; //  width             radius	  radius
-    double dim2; //  height            height      -
-    double dim3; //  depth             -           -
+    std::chrono::steady_clock::time_point last;
+    bool running;
 
-    void draw(void)
+    // Tamamlanan adım sayısı ve henüz bir adıma yetmeyen süre (saniye)
+    long long ticks;
+    double remainder;
+
+public:
+    SimulationClock(void)
     {
-        // Bu metod, update metodunun içinden çağrılır.
-        // update metodu cismin merkezine gelmesi gereken yeri
-        // orijine denk getirmiştir. Cismin tipine göre çizim
-        // gerçekleştirilir.
+        running = false;
+        ticks = 0;
+        remainder = 0;
+    }
+    long long advance(void)
+    {
+        // Son çağrıdan beri geçen duvar saati süresini ekler.
+        // (İlk çağrıda saat başlatılır, süre eklenmez.)
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double elapsed = 0;
+        if (running)
+            elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+        running = true;
+        return advance(elapsed);
+    }
+    long long advance(double seconds)
+    {
+        // Verilen süreyi ekler ve tamamlanan adım sayısını döndürür
+        remainder += std::max(seconds, 0.0);
+        long long steps = (long long)std::floor(remainder * SIMULATION_RATE);
+        ticks += steps;
+        remainder -= (double)steps / SIMULATION_RATE;
+        return steps;
+    }
+    void seek(double seconds)
+    {
+        // Simülasyonu doğrudan verilen ana taşır
+        seconds = std::max(seconds, 0.0);
+        ticks = (long long)std::floor(seconds * SIMULATION_RATE);
+        remainder = seconds - (double)ticks / SIMULATION_RATE;
+    }
+    long long getTicks(void)
+    {
+        return ticks;
+    }
+    double getAlpha(void)
+    {
+        // Son adımdan bir sonrakine kadarki kesir (0-1)
+        return remainder * SIMULATION_RATE;
+    }
+    double getTime(void)
+    {
+        // Çizilecek an (saniye): son adım ile bir sonraki arası
+        return (ticks + getAlpha()) / SIMULATION_RATE;
+    }
+};
 
-        if (shape == RECTANGULARPRISM)
-        {
-            glScaled(dim1, dim2, dim3);
-            glutSolidCube(1.0);
-        }
-        else if (shape == CYLINDER)
-        {
-            GLUquadricObj *quadratic;
-            quadratic = gluNewQuadric();
+double lapSeconds(std::chrono::steady_clock::time_point &start)
+{
+    // start'tan beri geçen süre (saniye); start şimdiki ana alınır,
+    // böylece art arda çağrılarla aşamalar ayrı ayrı ölçülür.
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - start).count();
+    start = now;
+    return seconds;
+}
 
-            // Silindir OpengGL tarafından varsayılan olarak
-            // orijinden z pozitife uzanacak şekilde çizildiği
-            // için istenilen doğrultuya denk getirmek amacıyla
-            // iç döndürme yapılıyor. (Eklem döndürmesinden farklıdır)
-            glRotated(rotate.x, 1, 0, 0);
-            glRotated(rotate.y, 0, 1, 0);
-            glRotated(rotate.z, 0, 0, 1);
-            glTranslated(0, 0, -dim2 / 2); // Orta noktadan dönmesi için
+/////////////////////////////////////////////////////////////////// PROFİL
 
-            gluCylinder(quadratic, dim1, dim1, dim2, 64, 64);
-        }
-        else if (shape == SPHERE)
-        {
-            glutSolidSphere(this->dim1, 128, 128);
-        }
-    }
+/*
+Profiler, bir karenin aşamalarını iç içe kapsamlar (scope) halinde
+ölçer. Her begin/end çifti bir kapsamdır; aynı üst kapsam altında aynı
+isimle tekrar açılan kapsamlar (ör. kalabalıktaki her modelin
+walkAnimation'ı) tek satırda toplanır ve çağrı sayısı tutulur.
+
+GPU süreleri GL zamanlayıcı sorgularıyla (GL_TIME_ELAPSED) ölçülür. Bu
+sorgular iç içe açılamadığı için GPU ölçümü, başka bir GPU ölçümü
+açık değilken ve kapsam o karede ilk kez açılıyorsa başlar. Sonuçlar
+boru hattını bekletmemek için PROFILER_QUERY_FRAMES kare sonra okunur;
+HUD ve CSV bu yüzden birkaç kare geriden gelir.
+*/
 
-    // Cismin rengi ve iç döndürmesi (eklem dönmesiyle alakasız-silindir için kullanılıyor)
+#define PROFILER_QUERY_FRAMES 4
 
-    RGBA color;
-    Angles rotate;
+typedef struct profileScope
+{
+    const char *name;
+    int parent, depth;
+    int calls;
+    double cpuSeconds;
 
-    // Cisim başka bir cisme bağlanmıyorsa TRUE
+    // GPU ölçümü yoksa query 0, gpuSeconds -1 kalır
+    GLuint query;
+    double gpuSeconds;
+} ProfileScope;
 
-    bool rootObject;
+typedef struct profileFrame
+{
+    long long number;
+    bool pending;
+    std::vector<ProfileScope> scopes;
+} ProfileFrame;
 
-    // Cismin bağlı olduğu eksenin cismin ortasına göre koordinatı
+class Profiler
+{
+private:
+    bool enabled, gpuTimers;
 
-    Coordinates offsetOfJointToParent;
+    // Sıfırdan büyükse ölçüm yapılmaz (bkz. WorkerPool::parallelFor)
+    int paused;
 
-public:
-    // Taşınan cisimler için o cisimlerin pointer'ları,
-    // ve o cisimlerle eklemlerinin açı ve offset bilgileri
+    // Ölçümler yalnızca profiler'ı oluşturan (ana) iş parçacığında
+    // yapılır; diğer iş parçacıklarının begin/end çağrıları yok sayılır.
+    std::thread::id owner;
 
-    std::vector<Object *> children;
-    std::vector<Angles> jointAngles;
-    std::vector<Coordinates> jointOffsets;
+    // Sonuçları beklenen son kareler (halka) ve tamamlanan son kare
+    ProfileFrame frames[PROFILER_QUERY_FRAMES];
+    ProfileFrame latest;
+    long long frameNumber;
 
-    // Constructor
+    // Açık kapsamlar ve başlangıç anları
+    std::vector<int> stack;
+    std::vector<std::chrono::steady_clock::time_point> starts;
+    bool gpuQueryOpen;
+    std::vector<GLuint> freeQueries;
 
-    Object(int shape, bool rootObject = false)
+    std::ofstream csv;
+
+    static bool supportsTimerQueries(void)
     {
-        // Cismin şeklini işaretlemek
-        this->shape = shape;
+        // GL 3.3 veya ARB/EXT_timer_query
+        const char *version = (const char *)glGetString(GL_VERSION);
+        const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+        int major = 0, minor = 0;
+        if (version)
+        {
+            major = atoi(version);
+            const char *dot = strchr(version, '.');
+            if (dot)
+                minor = atoi(dot + 1);
+        }
+        if (major > 3 || (major == 3 && minor >= 3))
+            return true;
+        return extensions && (strstr(extensions, "GL_ARB_timer_query") || strstr(extensions, "GL_EXT_timer_query"));
+    }
 
-        // Cismin bağlanma durumu
-        this->rootObject = rootObject;
-        if (rootObject)
+    ProfileFrame &current(void)
+    {
+        return frames[frameNumber % PROFILER_QUERY_FRAMES];
+    }
+
+    bool resolve(ProfileFrame &frame, bool wait)
+    {
+        // Karenin tüm GPU sonuçları hazırsa (veya beklenmesi isteniyorsa)
+        // okunur, kare CSV'ye yazılır ve HUD'a verilir.
+        if (!frame.pending)
+            return true;
+        for (size_t i = 0; i < frame.scopes.size() && !wait; i++)
+            if (frame.scopes[i].query)
+            {
+                GLint available = 0;
+                glGetQueryObjectiv(frame.scopes[i].query, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available)
+                    return false;
+            }
+        for (size_t i = 0; i < frame.scopes.size(); i++)
         {
-            // Cisim başka bir cisme bağlanmıyorsa bağlanma değerleri 0 işaretlenir.
-            // (update metodu için gerekli)
-            Coordinates offsetOfJointToParent;
-            offsetOfJointToParent.x = offsetOfJointToParent.y = offsetOfJointToParent.z = 0;
+            ProfileScope &scope = frame.scopes[i];
+            if (!scope.query)
+                continue;
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(scope.query, GL_QUERY_RESULT, &nanoseconds);
+            scope.gpuSeconds = nanoseconds * 1e-9;
+            freeQueries.push_back(scope.query);
+            scope.query = 0;
         }
+        frame.pending = false;
+        latest = frame;
+        writeCsv(frame);
+        return true;
     }
 
-    void set(
-        double widthOrRadius, double height, double depth,
-        double red, double green, double blue,
-        double rotateX, double rotateY, double rotateZ)
+    void writeCsv(const ProfileFrame &frame)
     {
-        // 1.2.3. argümanlar cismin ölçüleridir.
-        // Şekil dikdörtgenler prizmasıysa
-        // width-height-depth olarak kullanılır,
-        // silindirse radius ve height olarak kullanılır,
-        // küreyse radius olarak kullanılır. Gerek olmayan
-        // değerler yerine 0 verilerek çağrılır.
+        // Her kapsam için bir satır: kare, kapsamın yolu, çağrı sayısı,
+        // CPU ve GPU süreleri (ms, GPU ölçümü yoksa boş)
+        if (!csv.is_open())
+            return;
+        for (size_t i = 0; i < frame.scopes.size(); i++)
+        {
+            const ProfileScope &scope = frame.scopes[i];
+            std::string path = scope.name;
+            for (int parent = scope.parent; parent >= 0; parent = frame.scopes[parent].parent)
+                path = std::string(frame.scopes[parent].name) + "/" + path;
+            csv << frame.number << "," << path << "," << scope.calls << "," << scope.cpuSeconds * 1000.0 << ",";
+            if (scope.gpuSeconds >= 0)
+                csv << scope.gpuSeconds * 1000.0;
+            csv << "\n";
+        }
+        csv.flush();
+    }
 
-        // 4.5.6 argümanlar renktir.
+public:
+    Profiler(void)
+    {
+        enabled = false;
+        gpuTimers = false;
+        paused = 0;
+        owner = std::this_thread::get_id();
+        gpuQueryOpen = false;
+        frameNumber = 0;
+        latest.pending = false;
+        latest.number = -1;
+        for (int i = 0; i < PROFILER_QUERY_FRAMES; i++)
+            frames[i].pending = false;
+    }
+    bool init(const std::string &csvPath)
+    {
+        // OpenGL bağlamı oluşturulduktan sonra çağrılmalı
+        if (enabled)
+            return true;
+        enabled = true;
+        gpuTimers = supportsTimerQueries();
+        if (csvPath.empty())
+            return true;
+        csv.open(csvPath.c_str());
+        if (!csv)
+        {
+            std::cerr << "profil dosyası açılamadı: " << csvPath << std::endl;
+            return false;
+        }
+        csv << "frame,scope,calls,cpu_ms,gpu_ms\n";
+        return true;
+    }
+    bool isEnabled(void)
+    {
+        return enabled;
+    }
+    void beginFrame(void)
+    {
+        if (!enabled)
+            return;
 
-        // 7.8.9. argümanlar iç döndürmedir. (eklem
-        // döndürmesindenbağımsız)
+        // Halkada yer açmak için en eski karenin sonuçları beklenir
+        // (normalde endFrame'de çoktan okunmuş olur).
+        ProfileFrame &frame = current();
+        resolve(frame, true);
+        frame.number = frameNumber;
+        frame.pending = true;
+        frame.scopes.clear();
+        stack.clear();
+        starts.clear();
+    }
+    void begin(const char *name, bool gpu = false)
+    {
+        if (!enabled || paused || std::this_thread::get_id() != owner)
+            return;
 
-        this->dim1 = widthOrRadius;
-        if (shape != SPHERE)
+        ProfileFrame &frame = current();
+        int parent = stack.empty() ? -1 : stack.back();
+        int index = -1;
+        for (int i = frame.scopes.size() - 1; i >= 0 && index < 0; i--)
+            if (frame.scopes[i].parent == parent && strcmp(frame.scopes[i].name, name) == 0)
+                index = i;
+
+        if (index < 0)
         {
-            this->dim2 = height;
-            if (shape != CYLINDER)
+            ProfileScope scope;
+            scope.name = name;
+            scope.parent = parent;
+            scope.depth = stack.size();
+            scope.calls = 0;
+            scope.cpuSeconds = 0;
+            scope.query = 0;
+            scope.gpuSeconds = -1;
+            if (gpu && gpuTimers && !gpuQueryOpen)
             {
-                this->dim3 = depth;
+                if (freeQueries.empty())
+                {
+                    freeQueries.push_back(0);
+                    glGenQueries(1, &freeQueries.back());
+                }
+                scope.query = freeQueries.back();
+                freeQueries.pop_back();
+                glBeginQuery(GL_TIME_ELAPSED, scope.query);
+                gpuQueryOpen = true;
             }
+            frame.scopes.push_back(scope);
+            index = frame.scopes.size() - 1;
         }
 
-        this->color.red = red;
-        this->color.green = green;
-        this->color.blue = blue;
+        frame.scopes[index].calls++;
+        stack.push_back(index);
+        starts.push_back(std::chrono::steady_clock::now());
+    }
+    void end(void)
+    {
+        if (!enabled || paused || stack.empty() || std::this_thread::get_id() != owner)
+            return;
 
-        this->rotate.x = rotateX;
-        this->rotate.y = rotateY;
-        this->rotate.z = rotateZ;
+        ProfileFrame &frame = current();
+        ProfileScope &scope = frame.scopes[stack.back()];
+        scope.cpuSeconds += lapSeconds(starts.back());
+        if (scope.query && gpuQueryOpen && scope.calls == 1)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            gpuQueryOpen = false;
+        }
+        stack.pop_back();
+        starts.pop_back();
     }
+    void endFrame(void)
+    {
+        if (!enabled)
+            return;
 
-    void link(
-        Object &child,
-        double jointAngleX, double jointAngleY, double jointAngleZ,
-        double parentOffsetX, double parentOffsetY, double parentOffsetZ,
-        double childOffsetX, double childOffsetY, double childOffsetZ)
+        // Sonuçları hazır olan kareler sırayla okunur
+        frameNumber++;
+        for (long long number = frameNumber - PROFILER_QUERY_FRAMES; number < frameNumber; number++)
+            if (number >= 0 && !resolve(frames[number % PROFILER_QUERY_FRAMES], false))
+                break;
+    }
+    void flush(void)
     {
-        /*
-		a.link(b, açı, a-ofset, b-ofset);
-		a nesnesi ana organdır.
-		b nesnesi a'ya bağlı organdır.
-		(2.3.4. parametre) b'nin a'ya göre duruş açısı (yada eklem açısı denebilir)
-		(5.6.7. parametre) a-ofset, a'nın merkezi orijin kabul edildiğinde eklem noktasının koordinatıdır
-		(8.9.10. parametre) b-ofset, b'nin merkezi orijin kabul edildiğinde eklem noktasının koordinatıdır
+        // Bekleyen tüm karelerin sonuçları beklenip yazılır
+        if (!enabled)
+            return;
+        for (long long number = frameNumber - PROFILER_QUERY_FRAMES; number < frameNumber; number++)
+            if (number >= 0)
+                resolve(frames[number % PROFILER_QUERY_FRAMES], true);
+    }
+    const ProfileFrame &getLatest(void)
+    {
+        // Sonuçları tamamlanan en son kare
+        return latest;
+    }
+    void pause(void)
+    {
+        if (std::this_thread::get_id() == owner)
+            paused++;
+    }
+    void resume(void)
+    {
+        if (std::this_thread::get_id() == owner)
+            paused--;
+    }
+};
 
-		Object tipindeki A nesnesi(ana nesne) yine Object tipindeki
-		B nesnesine(bağlanan nesne) bağlanabilir. Bu bağlanma eklem
-		noktasını temsil eder. A'nın, A'nın hangi noktasından, B'nin
-		hangi noktasına hangi açıyla bağlanacağı belirtilir. Bu
-		bilgiler A ve B nesnesine kaydedilir. A'daki 3 vektör, A'ya
-		bağlanan B gibi tüm nesnelerin bilgilerini tutar. B'deki
-		offsetOfParentObject değişkeni eklem noktasının B'nin merkezine
-		olan uzaklığını saklar ve bu metodun işlevi biter.
-		*/
+// Tüm sınıfların kullandığı profil ölçümleri
+Profiler profiler;
 
-        this->children.push_back(&child);
+/////////////////////////////////////////////////////////////////// İŞ PAYLAŞIMI
 
-        Angles jointAngle = {jointAngleX, jointAngleY, jointAngleZ};
-        this->jointAngles.push_back(jointAngle);
+/*
+WorkerPool, bir aralığın (ör. kalabalıktaki modeller) parçalarını
+tüm çekirdeklere dağıtır. Aralık grain boyunda parçalara bölünüp
+işçilerin kuyruklarına sırayla dağıtılır. Her işçi önce kendi
+kuyruğunun önünden alır, kuyruğu boşalınca diğerlerinin kuyruğunun
+arkasından çalar (work stealing). parallelFor'u çağıran iş parçacığı
+da işçi 0 olarak çalışır ve tüm parçalar bitmeden dönmez.
+
+Parçaların sınırları yalnızca grain'e bağlıdır ve her parça kendi
+verisine yazar; sonuç iş parçacığı sayısından bağımsızdır. Profil
+ölçümleri tek iş parçacıklı olduğu için paralel bölgede durdurulur.
+
+Havuz aynı anda tek bir işi dağıtır. İşçiler başka bir iş parçacığının
+(ör. simülasyon) işiyle meşgulken parallelFor'u çağıran beklemez,
+aralığı kendisi sırayla işler.
+*/
 
-        Coordinates parentOffset = {parentOffsetX, parentOffsetY, parentOffsetZ};
-        this->jointOffsets.push_back(parentOffset);
+class WorkerPool
+{
+private:
+    typedef struct workerQueue
+    {
+        std::mutex lock;
+        std::deque<std::pair<int, int>> ranges;
+    } WorkerQueue;
+
+    std::vector<std::thread> threads;
+    std::unique_ptr<WorkerQueue[]> queues;
+    int workerCount;
+
+    // Çalışan iş, iş numarası (işçileri uyandırmak için) ve
+    // bitmemiş parça sayısı
+    std::mutex lock;
+    std::condition_variable wake, done;
+    const std::function<void(int, int)> *task;
+    std::mutex busy;
+    unsigned int generation;
+    bool stopping;
+    std::atomic<int> remaining;
+
+    bool runOne(int worker)
+    {
+        // Önce kendi kuyruğunun önü, sonra diğerlerinin arkası
+        std::pair<int, int> range;
+        bool found = false;
+        for (int k = 0; k < workerCount && !found; k++)
+        {
+            WorkerQueue &queue = queues[(worker + k) % workerCount];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.ranges.empty())
+                continue;
+            if (k == 0)
+            {
+                range = queue.ranges.front();
+                queue.ranges.pop_front();
+            }
+            else
+            {
+                range = queue.ranges.back();
+                queue.ranges.pop_back();
+            }
+            found = true;
+        }
+        if (!found)
+            return false;
 
-        Coordinates childOffset = {childOffsetX, childOffsetY, childOffsetZ};
-        child.offsetOfJointToParent = childOffset;
+        (*task)(range.first, range.second);
+        if (--remaining == 0)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            done.notify_all();
+        }
+        return true;
+    }
 
-        return;
+    void workerLoop(int worker)
+    {
+        unsigned int seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+            while (runOne(worker))
+                ;
+        }
     }
 
-    void update(void)
+public:
+    WorkerPool(void)
     {
-        // Cismin renk bilgileri OpenGL'e iletilir.
+        workerCount = 1;
+        task = NULL;
+        generation = 0;
+        stopping = false;
+        remaining = 0;
+        queues.reset(new WorkerQueue[1]);
+    }
+    ~WorkerPool(void)
+    {
+        shutdown();
+    }
 
-        glColor3d(this->color.red, this->color.green, this->color.blue);
+    void init(int threadCount)
+    {
+        // threadCount <= 0 ise tüm çekirdekler kullanılır
+        shutdown();
+        if (threadCount <= 0)
+            threadCount = std::max((int)std::thread::hardware_concurrency(), 1);
+        workerCount = threadCount;
+        queues.reset(new WorkerQueue[workerCount]);
+        stopping = false;
+        for (int worker = 1; worker < workerCount; worker++)
+            threads.push_back(std::thread(&WorkerPool::workerLoop, this, worker));
+    }
+    void shutdown(void)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+        threads.clear();
+        workerCount = 1;
+    }
+    int size(void)
+    {
+        return workerCount;
+    }
 
-        // Bu metod gövde için çağrıldığında translate ile 0,0,0 kaydırması
-        // yapılıp gövde çizilir. Gövdeye bağlı bir cisim için çağrıldığında
-        // eklemin cismin merkezine göre koordinatı (offset) kadar kaydırma
-        // yapılıp orijini cismin çizilmesi gereken noktaya kaydırır.
+    void parallelFor(int count, int grain, const std::function<void(int, int)> &body)
+    {
+        // body(başlangıç, bitiş) [0, count) aralığının grain boyundaki
+        // parçaları için çağrılır.
+        grain = std::max(grain, 1);
+        int chunks = (count + grain - 1) / grain;
+        if (chunks <= 0)
+            return;
+        std::unique_lock<std::mutex> claim(busy, std::try_to_lock);
+        if (workerCount == 1 || chunks == 1 || !claim.owns_lock())
+        {
+            for (int first = 0; first < count; first += grain)
+                body(first, std::min(first + grain, count));
+            return;
+        }
 
-        glTranslated(
-            offsetOfJointToParent.x,
-            offsetOfJointToParent.y,
-            offsetOfJointToParent.z);
+        profiler.pause();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            task = &body;
+            remaining = chunks;
+            for (int chunk = 0; chunk < chunks; chunk++)
+            {
+                WorkerQueue &queue = queues[chunk % workerCount];
+                std::lock_guard<std::mutex> queueGuard(queue.lock);
+                queue.ranges.push_back(std::make_pair(chunk * grain, std::min((chunk + 1) * grain, count)));
+            }
+            generation++;
+        }
+        wake.notify_all();
 
-        // Mevcut konumlar (matris) saklanarak draw metodu çağrılır.
-        // (Silindir çiziminde rotate ve translate yapıldığı için push-pop
-        // gerekli.)
+        while (runOne(0))
+            ;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            done.wait(guard, [&] { return remaining == 0; });
+            task = NULL;
+        }
+        profiler.resume();
+    }
+};
 
-        glPushMatrix();
-        this->draw();
-        glPopMatrix();
+// Simülasyon aşamasının iş parçacıkları (bkz. --threads)
+WorkerPool workers;
 
-        // Cismin çizimi bu noktada bitmiştir. Mevcut konum çizilmiş cismin
-        // ortasını gösteriyordur.
+/////////////////////////////////////////////////////////////////// MESH ÖNBELLEĞİ
 
-        // Bu metod cismin çizimi bittiğinde bağlı cisimler için tekrar bu
-        // fonksiyonu çağırır. Ancak önce eklem noktasına ilerler.
+/*
+Mesh, bir şeklin üçgenlenmiş halini saklar. Her köşe için
+6 float tutulur: konum (x, y, z) ve normal (nx, ny, nz).
+İndeksler GL_TRIANGLES olarak çizilecek sıradadır.
+
+MeshCache aynı şekil, ölçü ve dilim/katman sayısı için
+üçgenlemeyi bir kere yapar ve tüm Object'lere aynı Mesh'i
+verir. Böylece her karede gluNewQuadric, glutSolidSphere
+gibi çağrılarla yeniden üçgenleme (ve quadric sızıntısı)
+yapılmaz.
+
+Birbirine göre hiç hareket etmeyen parçalar (bkz. Skeleton::mergeRigid)
+tek bir mesh'te birleştirilir. Birleşik mesh'te her köşenin rengi de
+(r, g, b) ayrı bir dizide tutulur; renk dizisi boş olan mesh cismin
+rengiyle çizilir.
+*/
 
-        // Aşağıdaki for döngüsü cisme bağlı cisim sayısı kadar tekrarlanır.
-        // Örneğin gövde için bağlı cisimler sol-omuz, sağ-omuz, sol-kalça,
-        // sağ-kalça ve boyundur. Yani 5 döngü gerçekleşir. Tabi sol-omuz için
-        // bu fonksiyon çağrıldığında ona bağlı olan 1 cisim vardır(sol-kol).
-        // Sonra sol-dirsek, sol-önkol için çağrılır ve çağrılar sonlanıp
-        // sağ-omuza(ikinci döngü) geçer.
+typedef struct mesh
+{
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+    std::vector<GLfloat> colors;
 
-        for (unsigned int i = 0, length = this->children.size(); i < length; i++)
+    void draw(void) const
+    {
+        // İstemci tarafı dizilerle tek çağrıda çizim
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glVertexPointer(3, GL_FLOAT, 6 * sizeof(GLfloat), &vertices[0]);
+        glNormalPointer(GL_FLOAT, 6 * sizeof(GLfloat), &vertices[3]);
+        if (!colors.empty())
         {
-            // Bir cisme bağlı birden fazla eklem olabileceği için her
-            // eklem için kaydırma yapmadan önce currentmatrix saklanıyor
-            // ve bir sonraki ekleme geçilmeden önce pop ile saklı matrix'e
-            // geri dönülüyor.
+            // GL_COLOR_MATERIAL açık olduğu için köşe renkleri
+            // glColor yerine geçer
+            glEnableClientState(GL_COLOR_ARRAY);
+            glColorPointer(3, GL_FLOAT, 0, &colors[0]);
+        }
+        glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, &indices[0]);
+        if (!colors.empty())
+            glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+    }
+} Mesh;
 
-            glPushMatrix();
+typedef struct meshKey
+{
+    int shape;
+    double dim1, dim2, dim3;
+    int slices, stacks;
 
-            // Bağlı cismin bağlanma noktasına kaydırma.
-            Coordinates offsets = this->jointOffsets[i];
-            glTranslated(offsets.x, offsets.y, offsets.z);
+    bool operator<(const struct meshKey &other) const
+    {
+        if (shape != other.shape)
+            return shape < other.shape;
+        if (dim1 != other.dim1)
+            return dim1 < other.dim1;
+        if (dim2 != other.dim2)
+            return dim2 < other.dim2;
+        if (dim3 != other.dim3)
+            return dim3 < other.dim3;
+        if (slices != other.slices)
+            return slices < other.slices;
+        return stacks < other.stacks;
+    }
+} MeshKey;
 
-            // Cismin bağlanma açısı (eklem açısı)
-            // 3 eksende dönme yapılıyor
-            Angles angles = this->jointAngles[i];
-            glRotated(angles.x, 1, 0, 0);
-            glRotated(angles.y, 0, 1, 0);
-            glRotated(angles.z, 0, 0, 1);
+class MeshCache
+{
+private:
+    // std::map düğümleri yer değiştirmediği için
+    // verilen Mesh pointer'ları önbellek yaşadıkça geçerlidir.
+    std::map<MeshKey, Mesh> meshes;
 
-            // Bu noktada çizilen cisim ile çizilecek cismin
-            // kesişme noktasına translate ve eklem açısına rotate
-            // ile gelindi. Çizilecek cisim için aynı metod çağrılıyor.
+    // Birleşik mesh'ler; anahtar parçaların mesh pointer'ları,
+    // matrisleri ve renklerinin baytlarıdır.
+    std::map<std::string, Mesh> mergedMeshes;
 
-            this->children[i]->update();
+    static void pushVertex(Mesh &m, double x, double y, double z, double nx, double ny, double nz)
+    {
+        m.vertices.push_back((GLfloat)x);
+        m.vertices.push_back((GLfloat)y);
+        m.vertices.push_back((GLfloat)z);
+        m.vertices.push_back((GLfloat)nx);
+        m.vertices.push_back((GLfloat)ny);
+        m.vertices.push_back((GLfloat)nz);
+    }
+    static void pushQuad(Mesh &m, GLuint a, GLuint b, GLuint c, GLuint d)
+    {
+        m.indices.push_back(a);
+        m.indices.push_back(b);
+        m.indices.push_back(c);
+        m.indices.push_back(a);
+        m.indices.push_back(c);
+        m.indices.push_back(d);
+    }
 
-            // Daha fazla birbirine uç uca bağlı cisim kalmadığında
-            // aynı cisme bağlı birden fazla cisim olabileceği için pop
-            // yapılıyor ve saklı konuma dönülüyor.
-            glPopMatrix();
+    static void buildSphere(Mesh &m, double radius, int slices, int stacks)
+    {
+        // glutSolidSphere gibi z ekseni etrafında dilimler,
+        // +z'den -z'ye katmanlar.
+        for (int i = 0; i <= stacks; i++)
+        {
+            double phi = PI * i / stacks;
+            for (int j = 0; j <= slices; j++)
+            {
+                double theta = 2 * PI * j / slices;
+                double nx = std::sin(phi) * std::cos(theta);
+                double ny = std::sin(phi) * std::sin(theta);
+                double nz = std::cos(phi);
+                pushVertex(m, radius * nx, radius * ny, radius * nz, nx, ny, nz);
+            }
+        }
+        for (int i = 0; i < stacks; i++)
+            for (int j = 0; j < slices; j++)
+            {
+                GLuint a = i * (slices + 1) + j;
+                GLuint b = (i + 1) * (slices + 1) + j;
+                pushQuad(m, a, b, b + 1, a + 1);
+            }
+    }
+    static void buildCylinder(Mesh &m, double radius, double height, int slices, int stacks)
+    {
+        // gluCylinder gibi orijinden z pozitife uzanan, kapaksız silindir
+        for (int i = 0; i <= stacks; i++)
+        {
+            double z = height * i / stacks;
+            for (int j = 0; j <= slices; j++)
+            {
+                double theta = 2 * PI * j / slices;
+                double nx = std::cos(theta);
+                double ny = std::sin(theta);
+                pushVertex(m, radius * nx, radius * ny, z, nx, ny, 0);
+            }
+        }
+        for (int i = 0; i < stacks; i++)
+            for (int j = 0; j < slices; j++)
+            {
+                GLuint a = i * (slices + 1) + j;
+                GLuint d = (i + 1) * (slices + 1) + j;
+                pushQuad(m, a, a + 1, d + 1, d);
+            }
+    }
+    static void buildBox(Mesh &m, double width, double height, double depth)
+    {
+        // glScaled + glutSolidCube(1.0) yerine ölçüleri köşelere
+        // işlenmiş kutu. Her yüzün kendi normali olduğu için
+        // yüz başına 4 köşe kullanılır.
+        static const double faces[6][3] = {
+            {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+        double half[3] = {width / 2, height / 2, depth / 2};
+        for (int f = 0; f < 6; f++)
+        {
+            // Normale dik iki eksen (u, v), u x v = normal olacak şekilde
+            int n = f / 2;
+            int u = (n + 1) % 3, v = (n + 2) % 3;
+            double sign = faces[f][n];
+            GLuint base = m.vertices.size() / 6;
+            static const double corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+            for (int c = 0; c < 4; c++)
+            {
+                double p[3];
+                p[n] = sign * half[n];
+                p[u] = corners[c][0] * half[u] * sign;
+                p[v] = corners[c][1] * half[v];
+                pushVertex(m, p[0], p[1], p[2], faces[f][0], faces[f][1], faces[f][2]);
+            }
+            pushQuad(m, base, base + 1, base + 2, base + 3);
         }
+    }
 
-        return;
+public:
+    const Mesh *get(int shape, double dim1, double dim2, double dim3, int slices, int stacks)
+    {
+        MeshKey key = {shape, dim1, dim2, dim3, slices, stacks};
+        std::map<MeshKey, Mesh>::iterator found = meshes.find(key);
+        if (found != meshes.end())
+            return &found->second;
+
+        Mesh &m = meshes[key];
+        if (shape == SPHERE)
+            buildSphere(m, dim1, slices, stacks);
+        else if (shape == CYLINDER)
+            buildCylinder(m, dim1, dim2, slices, stacks);
+        else if (shape == RECTANGULARPRISM)
+            buildBox(m, dim1, dim2, dim3);
+        return &m;
+    }
+    const Mesh *getMerged(const std::vector<const Mesh *> &parts, const std::vector<Matrix4> &matrices, const std::vector<RGBA> &colors)
+    {
+        // Parçalar matrisleriyle (dönme ve öteleme) ortak bir uzaya
+        // taşınıp renkleriyle tek mesh'e eklenir. Aynı iskelete sahip
+        // modeller aynı birleşik mesh'i paylaşır.
+        std::string key;
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            key.append((const char *)&parts[i], sizeof(parts[i]));
+            key.append((const char *)matrices[i].m, sizeof(matrices[i].m));
+            key.append((const char *)&colors[i], sizeof(colors[i]));
+        }
+        std::map<std::string, Mesh>::iterator found = mergedMeshes.find(key);
+        if (found != mergedMeshes.end())
+            return &found->second;
+
+        Mesh &m = mergedMeshes[key];
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            const Mesh &part = *parts[i];
+            const GLfloat *r = matrices[i].m;
+            GLuint base = m.vertices.size() / 6;
+            for (size_t v = 0; v < part.vertices.size(); v += 6)
+            {
+                const GLfloat *p = &part.vertices[v];
+                for (int k = 0; k < 3; k++)
+                    m.vertices.push_back(r[k] * p[0] + r[4 + k] * p[1] + r[8 + k] * p[2] + r[12 + k]);
+                for (int k = 0; k < 3; k++)
+                    m.vertices.push_back(r[k] * p[3] + r[4 + k] * p[4] + r[8 + k] * p[5]);
+                m.colors.push_back(colors[i].red);
+                m.colors.push_back(colors[i].green);
+                m.colors.push_back(colors[i].blue);
+            }
+            for (size_t index = 0; index < part.indices.size(); index++)
+                m.indices.push_back(base + part.indices[index]);
+        }
+        return &m;
     }
 };
 
-// Human metodları herhangi bir vücut parçasının
-// bilgilerini (eklem açısı vs.) güncellemek istediğinde
-// Object sınıfının ilgili metoduna aşağıdaki sabitler ile
-// komut gönderir.
+// Tüm Human nesnelerinin paylaştığı önbellek
+MeshCache meshCache;
 
-#define BODY 0
+/*
+Ayrıntı seviyesi seçimi: cismin sınır küresinin ekrandaki yarıçapı
+(piksel) eşiklerle karşılaştırılır. Eşikler, çokgen kenarının gerçek
+daireden sapması 0.25 pikseli geçmeyecek şekilde seçilmiştir; yani
+seviye değişimi görünmez.
+
+Seviyelerin sınırda her karede gidip gelmemesi için daha ayrıntılı
+seviyeye hemen geçilir, daha kabasına ise yarıçap sınırın %80'inin
+altına indiğinde geçilir.
+*/
 
-#define HEAD 1
-#define NECK 2
-#define LEFT_ARM 3
-#define LEFT_FOREARM 4
-#define LEFT_FOOT 5
-#define RIGHT_ARM 6
-#define RIGHT_FOREARM 7
-#define RIGHT_FOOT 8
+static const int sphereLodSlices[LOD_LEVELS] = {SPHERE_SLICES, 48, 20, 10};
+static const int sphereLodStacks[LOD_LEVELS] = {SPHERE_STACKS, 48, 20, 10};
+static const int cylinderLodSlices[LOD_LEVELS] = {CYLINDER_SLICES, 24, 12, 6};
+static const int cylinderLodStacks[LOD_LEVELS] = {CYLINDER_STACKS, 1, 1, 1};
+static const double lodPixelRadius[LOD_LEVELS] = {116, 20, 5, 0};
 
-#define LEFT_SHOULDER 9
-#define LEFT_ELBOW 10
-#define LEFT_HIP 11
-#define RIGHT_SHOULDER 12
-#define RIGHT_ELBOW 13
-#define RIGHT_HIP 14
+#define LOD_HYSTERESIS 0.8
 
-class Human
+int selectLodLevel(double pixelRadius, int current)
+{
+    int target = 0;
+    while (target < LOD_LEVELS - 1 && pixelRadius <= lodPixelRadius[target])
+        target++;
+
+    if (target < current)
+        return target;
+    if (target > current && pixelRadius < lodPixelRadius[current] * LOD_HYSTERESIS)
+        return target;
+    return current;
+}
+
+// Tampon tabanlı çizicinin tek bir çizim için ihtiyaç duyduğu bilgiler
+
+typedef struct drawItem
+{
+    const Mesh *mesh;
+    Matrix4 model;
+    RGBA color;
+} DrawItem;
+
+// Örnekli çizimde aynı mesh ile çizilecek ardışık örnekler
+
+typedef struct instanceBatch
+{
+    const Mesh *mesh;
+    int first, count;
+} InstanceBatch;
+
+/////////////////////////////////////////////////////////////////// VÜCUT MODELİ
+
+class Object
 {
+
 private:
-    // Object tipinde tüm vücut parçaları ve
-    // eklemler için nesneler oluşturuluyor.
+    int shape;   //  RECTANGULARPRISM  CYLINDER    SPHERE
+    double dim1; //  width             radius	  radius
+    double dim2; //  height            height      -
+    double dim3; //  depth             -           -
 
-    // Human::init içinde bu nesneler birbiriyle
-    // parent-child ilişkisiyle bağlanacak.
+    // Human::init sırasında önbellekten alınan, her ayrıntı seviyesi
+    // için üçgenlenmiş şekil ve o an seçili olan seviye
+    const Mesh *lods[LOD_LEVELS];
+    int lod;
+
+    // Cismin merkezini çevreleyen kürenin yarıçapı (LOD seçimi ve
+    // görünmezlik testi için)
+    double boundingRadius;
+
+    // Son görünmezlik testinin sonucu: cismin kendisi ve
+    // kendisine bağlı cisimlerle birlikte alt ağacı görünüyor mu
+    bool visible;
+    bool subtreeVisible;
+
+    // Eklemleri hiç oynamayan alt ağaçların birleştirilmesi (bkz.
+    // Skeleton::mergeRigid): alt ağacın kökü kendisiyle birlikte
+    // birleşen tüm cisimlerin mesh'lerini (her seviye için) ve onları
+    // kapsayan yarıçapı tutar; köke katılan cisimler ayrıca çizilmez.
+    // Kendi alt ağacının tamamı birleşmiş cisme (gözler gibi) hiç
+    // girilmez; diğerlerinden (omuz gibi) yalnızca sürülen çocuklarına
+    // geçilir.
+    const Mesh *rigidLods[LOD_LEVELS];
+    double rigidRadius;
+    bool rigid;
+    bool merged;
+    bool mergedSubtree;
 
-    Object
-        body,
-        head,
-        neck,
-        leftEyeOutside,
-        leftEyeInside,
-        leftArm,
-        leftForearm,
-        leftFoot,
-        leftShoulder,
-        leftElbow,
-        leftHip,
-        rightEyeOutside,
-        rightEyeInside,
-        rightArm,
-        rightForearm,
-        rightFoot,
-        rightShoulder,
-        rightElbow,
-        rightHip;
+    void draw(void)
+    {
+        // Bu metod, update metodunun içinden çağrılır.
+        // update metodu cismin merkezine gelmesi gereken yeri
+        // orijine denk getirmiştir. Cismin tipine göre çizim
+        // gerçekleştirilir.
 
-    // Tüm iskeletin durma noktası ve açısı
+        // Birleşik mesh'in köşeleri cismin merkezine göredir; iç
+        // döndürme köşelere işlenmiştir.
+        if (rigid)
+        {
+            rigidLods[lod]->draw();
+            return;
+        }
 
-    Coordinates mainPosition;
-    Angles mainAngle;
+        if (shape == CYLINDER)
+        {
+            // Silindir OpengGL tarafından varsayılan olarak
+            // orijinden z pozitife uzanacak şekilde çizildiği
+            // için istenilen doğrultuya denk getirmek amacıyla
+            // iç döndürme yapılıyor. (Eklem döndürmesinden farklıdır)
+            glRotated(rotate.x, 1, 0, 0);
+            glRotated(rotate.y, 0, 1, 0);
+            glRotated(rotate.z, 0, 0, 1);
+            glTranslated(0, 0, -dim2 / 2); // Orta noktadan dönmesi için
+        }
 
-    // Animasyonlar için açık-kapalı durumunu gösteren bool'lar
-    // Animasyonun döngüsünü tamamlama yüzdesi double'lar
-    // Animasyonun toplam kaç kare süreceğini gösteren double'lar (animasyonun hızını belirliyor)
+        // Kutu, küre ve silindir ölçüleriyle birlikte önbellekte
+        // üçgenlenmiş olarak bulunur.
+        lods[lod]->draw();
+    }
 
-    bool walking;
-    double walkingCompletionPercent;
-    double walkingTotalAnimationIteration;
+    // Cismin rengi ve iç döndürmesi (eklem dönmesiyle alakasız-silindir için kullanılıyor)
 
-    bool waving;
-    double wavingCompletionPercent;
-    double wavingTotalAnimationIteration;
+    RGBA color;
+    Angles rotate;
 
-    bool roaming;
-    double roamingCompletionPercent;
-    double roamingTotalAnimationIteration;
+    // Cisim başka bir cisme bağlanmıyorsa TRUE
 
-public:
-    // Human Constructor'ı member variable
-    // olan Object nesnelerinin constructor'larını
-    // çağırır ve bu esnada bu cisimlerin silindir-küre
-    // olma durumunu da işaretler.
+    bool rootObject;
 
-    Human(void)
-        : body(CYLINDER, ROOT_OBJECT)
+    // Cismin bağlı olduğu eksenin cismin ortasına göre koordinatı
 
-          ,
-          head(SPHERE), leftEyeOutside(SPHERE), leftEyeInside(SPHERE), rightEyeOutside(SPHERE), rightEyeInside(SPHERE), neck(CYLINDER)
+    Coordinates offsetOfJointToParent;
 
-          ,
-          leftArm(CYLINDER), leftForearm(CYLINDER), leftFoot(CYLINDER)
+public:
+    // Taşınan cisimler için o cisimlerin pointer'ları,
+    // ve o cisimlerle eklemlerinin açı ve offset bilgileri
 
-          ,
-          rightArm(CYLINDER), rightForearm(CYLINDER), rightFoot(CYLINDER)
+    std::vector<Object *> children;
+    std::vector<Coordinates> jointOffsets;
 
-          ,
-          leftShoulder(SPHERE), leftElbow(SPHERE), leftHip(SPHERE)
+    // Cismi parent'ına bağlayan eklemin açıları. link ile verilen açı
+    // bindAngles'ta durur; iskelet kurulduktan sonra joint, modelin
+    // poz dizisindeki yerini gösterir. (bkz. Skeleton::build)
+    Angles bindAngles;
+    Angles *joint;
 
-          ,
-          rightShoulder(SPHERE), rightElbow(SPHERE), rightHip(SPHERE)
+    // Constructor
+
+    Object(int shape, bool rootObject = false)
     {
-        walkingCompletionPercent = 0;
-        wavingCompletionPercent = 0;
-        walking = false;
-        waving = false;
-        roaming = false;
+        // Cismin şeklini işaretlemek
+        this->shape = shape;
+        this->dim1 = this->dim2 = this->dim3 = 0;
+        this->lod = 0;
+        this->boundingRadius = 0;
+        this->visible = this->subtreeVisible = true;
+        this->color.alpha = 1;
+        this->rigidRadius = 0;
+        this->rigid = this->merged = this->mergedSubtree = false;
 
-        mainPosition = {0, -0.07, 0};
-        mainAngle = {0, 0, 0};
-        return;
+        // Cismin bağlanma durumu
+        this->rootObject = rootObject;
+
+        // Cisim başka bir cisme bağlanmıyorsa bağlanma değerleri 0 kalır.
+        // (update metodu için gerekli)
+        offsetOfJointToParent.x = offsetOfJointToParent.y = offsetOfJointToParent.z = 0;
+        bindAngles.x = bindAngles.y = bindAngles.z = 0;
+        joint = &bindAngles;
     }
-    void init(void)
-    {
-        // Bu metod OpenGL ile ilk defa iletişim kurulduğunda
-        // çağrılır ve her Human nesnesi için bir kere çalışır.
 
-        // Görevi her vücut parçası için ölçü, renk, iç döndürme
-        // tanımlamalarını yapar ve parçaları parent-child ilişkisine
-        // göre linkler.
-
-        // PARÇALARIN OLUŞTURULMASI, ÖLÇÜLENDİRİLMESİ
-
-        rightEyeOutside.set(
-            0.1, 0, 0, // yarıçap / boş / boş
-            1, 1, 1,   // color
-            0, 0, 0    // rotation
-        );
-        rightEyeInside.set(
-            0.04, 0, 0,    // yarıçap / yükseklik / boş
-            0.5, 0.3, 0.1, // color
-            0, 0, 0        // rotation
-        );
-
-        leftEyeOutside.set(
-            0.1, 0, 0, // yarıçap / boş / boş
-            1, 1, 1,   // color
-            0, 0, 0    // rotation
-        );
-        leftEyeInside.set(
-            0.04, 0, 0,    // yarıçap / yükseklik / boş
-            0.5, 0.3, 0.1, // color
-            0, 0, 0        // rotation
-        );
-
-        head.set(
-            0.5, 0, 0, // yarıçap / boş / boş
-            1, 0.6, 0, // color
-            0, 0, 0    // rotation
-        );
-
-        neck.set(            // yarıçap / yükseklik / boş
-            0.1, 0.2, 0,     // color
-            0.13, 0.26, 1.0, // rotation
-            90, 0, 0);
-
-        body.set(
-            0.5, 1.3, 0, // yarıçap / yükseklik / boş
-            1, 0.6, 0,   // color
-            90, 0, 0     // rotation
-        );
-
-        rightShoulder.set(
-            0.1001, 0, 0, // yarıçap / boş / boş
-            1, 0, 0,      // color
-            0, 0, 0       // rotation
-        );
-        rightArm.set(
-            0.1, 0.7, 0,      // yarıçap / yükseklik / boş
-            0.12, 0.38, 0.25, // color
-            0, 90, 0          // rotation
-        );
-        rightElbow.set(
-            0.1001, 0, 0, // yarıçap / boş / boş
-            1, 0, 0,      // color
-            0, 0, 0       // rotation
-        );
-        rightForearm.set(
-            0.1, 0.7, 0, // yarıçap / yükseklik / boş
-            1, 1, 0,     // color
-            0, 90, 0     // rotation
-        );
-
-        leftShoulder.set(
-            0.1001, 0, 0, // yarıçap / boş / boş
-            1, 0, 0,      // color
-            0, 0, 0       // rotation
-        );
-        leftArm.set(
-            0.1, 0.7, 0,      // yarıçap / yükseklik / boş
-            0.12, 0.38, 0.25, // color
-            0, 90, 0          // rotation
-        );
-        leftElbow.set(
-            0.1001, 0, 0, // yarıçap / boş / boş
-            1, 0, 0,      // color
-            0, 0, 0       // rotation
-        );
-        leftForearm.set(
-            0.1, 0.7, 0, // yarıçap / yükseklik / boş
-            1, 1, 0,     // color
-            0, 90, 0     // rotation
-        );
-
-        rightHip.set(
-            0.1001, 0, 0, // yarıçap / boş / boş
-            1, 0, 0,      // color
-            0, 0, 0       // rotation
-        );
-        rightFoot.set(
-            0.1, 1.0, 0,      // yarıçap / yükseklik / boş
-            0.12, 0.38, 0.25, // color
-            90, 0, 90         // rotation
-        );
-
-        leftHip.set(
-            0.1001, 0, 0, // yarıçap / boş / boş
-            1, 0, 0,      // color
-            0, 0, 0       // rotation
-        );
-        leftFoot.set(
-            0.1, 1.0, 0,      // yarıçap / yükseklik / boş
-            0.12, 0.38, 0.25, // color
-            90, 0, 90         // rotation
-        );
-
-        // PARÇALARIN BİRLEŞTİRİLMESİ (İSKELET)
-
-        body.link(         // parent
-            rightShoulder, // child
-            0, 0, 0,       // eklem açısı
-            -0.5, 0.3, 0,  // parent offset
-            0, 0, 0        // child offset
-        );
-        rightShoulder.link( // parent
-            rightArm,       // child
-            0, 0, 6,        // eklem açısı
-            0, 0, 0,        // parent offset
-            -0.35, 0, 0     // child offset
-        );
-        rightArm.link(   // parent
-            rightElbow,  // child
-            0, 0, 0,     // eklem açısı
-            -0.35, 0, 0, // parent offset
-            0, 0, 0      // child offset
-        );
-        rightElbow.link(  // parent
-            rightForearm, // child
-            0, 0, -90,    // eklem açısı
-            0, 0, 0,      // parent offset
-            -0.35, 0, 0   // child offset
-        );
-
-        body.link(        // parent
-            leftShoulder, // child
-            0, 0, 0,      // eklem açısı
-            0.5, 0.3, 0,  // parent offset
-            0, 0, 0       // child offset
-        );
-        leftShoulder.link( // parent
-            leftArm,       // child
-            0, 0, -6,      // eklem açısı
-            0, 0, 0,       // parent offset
-            0.35, 0, 0     // child offset
-        );
-        leftArm.link(   // parent
-            leftElbow,  // child
-            0, 0, 0,    // eklem açısı
-            0.35, 0, 0, // parent offset
-            0, 0, 0     // child offset
-        );
-        leftElbow.link(  // parent
-            leftForearm, // child
-            0, 0, 90,    // eklem açısı
-            0, 0, 0,     // parent offset
-            0.35, 0, 0   // child offset
-        );
-
-        body.link(          // parent
-            leftHip,        // child
-            0, 0, -10,      // eklem açısı
-            -0.2, -0.65, 0, // parent offset
-            0, 0, 0         // child offset
-        );
-        leftHip.link(  // parent
-            leftFoot,  // child
-            0, 0, 0,   // eklem açısı
-            0, 0, 0,   // parent offset
-            0, -0.5, 0 // child offset
-        );
-
-        body.link(         // parent
-            rightHip,      // child
-            0, 0, 10,      // eklem açısı
-            0.2, -0.65, 0, // parent offset
-            0, 0, 0        // child offset
-        );
-        rightHip.link( // parent
-            rightFoot, // child
-            0, 0, 0,   // eklem açısı
-            0, 0, 0,   // parent offset
-            0, -0.5, 0 // child offset
-        );
-
-        body.link(      // parent
-            neck,       // child
-            0, 0, 0,    // eklem açısı
-            0, 0.65, 0, // parent offset
-            0, 0.1, 0   // child offset
-        );
-        neck.link(     // parent
-            head,      // child
-            0, 0, 0,   // eklem açısı
-            0, 0.1, 0, // parent offset
-            0, 0.5, 0  // child offset
-        );
-
-        head.link(           // parent
-            rightEyeOutside, // child
-            0, 0, 0,         // eklem açısı
-            -0.2, 0.1, 0.4,  // parent offset
-            0, 0, 0          // child offset
-        );
-        rightEyeOutside.link( // parent
-            rightEyeInside,   // child
-            0, 0, 0,          // eklem açısı
-            0, 0, 0,          // parent offset
-            -0.01, 0.01, 0.1  // child offset
-        );
-
-        head.link(          // parent
-            leftEyeOutside, // child
-            0, 0, 0,        // eklem açısı
-            0.2, 0.1, 0.4,  // parent offset
-            0, 0, 0         // child offset
-        );
-        leftEyeOutside.link( // parent
-            leftEyeInside,   // child
-            0, 0, 0,         // eklem açısı
-            0, 0, 0,         // parent offset
-            0.01, 0.01, 0.1  // child offset
-        );
+    void setShape(int shape)
+    {
+        // Şekil iskelet dosyasından geldiğinde set'ten önce çağrılır
+        this->shape = shape;
     }
-    void update(void)
+
+    void set(
+        double widthOrRadius, double height, double depth,
+        double red, double green, double blue,
+        double rotateX, double rotateY, double rotateZ)
     {
-        // Sahneye çizilecek diğer nesneler için vücudun çizimi sırasında
-        // kullanılacak rotate-scale-translate'den sonra koordinatların
-        // değişme için push-pop kullanılıyor.
+        // 1.2.3. argümanlar cismin ölçüleridir.
+        // Şekil dikdörtgenler prizmasıysa
+        // width-height-depth olarak kullanılır,
+        // silindirse radius ve height olarak kullanılır,
+        // küreyse radius olarak kullanılır. Gerek olmayan
+        // değerler yerine 0 verilerek çağrılır.
 
-        glPushMatrix();
+        // 4.5.6 argümanlar renktir.
 
-        // Dolaşma animasyonu açıksa iskeletin konumunu animasyon belirler
-        // (Eğer kapalıysa değişiklik yapmadan return ediyor.)
-        roamingAnimation();
+        // 7.8.9. argümanlar iç döndürmedir. (eklem
+        // döndürmesindenbağımsız)
 
-        // İskeletin E-S-D-F ile dolaşması için
-        glTranslated(mainPosition.x, mainPosition.y, mainPosition.z);
-        glRotated(mainAngle.x, 1, 0, 0);
-        glRotated(mainAngle.y, 0, 1, 0);
-        glRotated(mainAngle.z, 0, 0, 1);
+        this->dim1 = widthOrRadius;
+        if (shape != SPHERE)
+        {
+            this->dim2 = height;
+            if (shape != CYLINDER)
+            {
+                this->dim3 = depth;
+            }
+        }
 
-        // wave-walk animasyonları cisim çizilmeden önce çalışıp
-        // eklem eğimlerini düzenliyor.
-        waveAnimation();
-        walkAnimation();
+        this->color.red = red;
+        this->color.green = green;
+        this->color.blue = blue;
 
-        glPushMatrix();
+        this->rotate.x = rotateX;
+        this->rotate.y = rotateY;
+        this->rotate.z = rotateZ;
 
-        // Zemine batmaması için model yükseltiliyor.
-        glTranslated(0.0, 1.7, 0.0);
+        // Ölçüler belli olduğu için her ayrıntı seviyesinin üçgenlemesi
+        // önbellekten alınır. (Aynı ölçülü parçalar aynı Mesh'i paylaşır.)
+        for (int level = 0; level < LOD_LEVELS; level++)
+        {
+            if (shape == SPHERE)
+                this->lods[level] = meshCache.get(shape, dim1, 0, 0, sphereLodSlices[level], sphereLodStacks[level]);
+            else if (shape == CYLINDER)
+                this->lods[level] = meshCache.get(shape, dim1, dim2, 0, cylinderLodSlices[level], cylinderLodStacks[level]);
+            else
+                this->lods[level] = meshCache.get(shape, dim1, dim2, dim3, 0, 0);
+        }
 
-        // Gövde nesnesi için çizim fonksiyonu çağrılıyor. Bu metod, kendisine
-        // bağlı cisimler için içinden çağrılacak ve tüm vücut çizilmiş olacak.
-        body.update();
+        if (shape == SPHERE)
+            boundingRadius = dim1;
+        else if (shape == CYLINDER)
+            boundingRadius = std::sqrt(dim1 * dim1 + dim2 * dim2 / 4);
+        else
+            boundingRadius = std::sqrt(dim1 * dim1 + dim2 * dim2 + dim3 * dim3) / 2;
+    }
 
-        glPopMatrix();
+    void link(
+        Object &child,
+        double jointAngleX, double jointAngleY, double jointAngleZ,
+        double parentOffsetX, double parentOffsetY, double parentOffsetZ,
+        double childOffsetX, double childOffsetY, double childOffsetZ)
+    {
+        /*
+		a.link(b, açı, a-ofset, b-ofset);
+		a nesnesi ana organdır.
+		b nesnesi a'ya bağlı organdır.
+		(2.3.4. parametre) b'nin a'ya göre duruş açısı (yada eklem açısı denebilir)
+		(5.6.7. parametre) a-ofset, a'nın merkezi orijin kabul edildiğinde eklem noktasının koordinatıdır
+		(8.9.10. parametre) b-ofset, b'nin merkezi orijin kabul edildiğinde eklem noktasının koordinatıdır
 
-        glPopMatrix();
+		Object tipindeki A nesnesi(ana nesne) yine Object tipindeki
+		B nesnesine(bağlanan nesne) bağlanabilir. Bu bağlanma eklem
+		noktasını temsil eder. A'nın, A'nın hangi noktasından, B'nin
+		hangi noktasına hangi açıyla bağlanacağı belirtilir. Bu
+		bilgiler A ve B nesnesine kaydedilir. A'daki 2 vektör, A'ya
+		bağlanan B gibi tüm nesnelerin bilgilerini tutar. B'deki
+		offsetOfParentObject değişkeni eklem noktasının B'nin merkezine,
+		bindAngles ise eklem açısını saklar ve bu metodun işlevi biter.
+		*/
+
+        this->children.push_back(&child);
+
+        Angles jointAngle = {jointAngleX, jointAngleY, jointAngleZ};
+        child.bindAngles = jointAngle;
+
+        Coordinates parentOffset = {parentOffsetX, parentOffsetY, parentOffsetZ};
+        this->jointOffsets.push_back(parentOffset);
+
+        Coordinates childOffset = {childOffsetX, childOffsetY, childOffsetZ};
+        child.offsetOfJointToParent = childOffset;
+
+        return;
     }
 
-    void setMainCoordinates(double x, double y, double z)
+    void update(void)
     {
-        // Modelin koordinatlarını seçer
-        mainPosition.x = x;
-        mainPosition.y = y;
-        mainPosition.z = z;
+        // Cisim ve bağlı cisimlerin tamamı görüş alanının dışındaysa
+        // hiçbiri çizilmez. (Kolun tamamı, göz ve başın tamamı gibi)
+        if (!subtreeVisible)
+            return;
+
+        // Cismin renk bilgileri OpenGL'e iletilir.
+
+        glColor3d(this->color.red, this->color.green, this->color.blue);
+
+        // Bu metod gövde için çağrıldığında translate ile 0,0,0 kaydırması
+        // yapılıp gövde çizilir. Gövdeye bağlı bir cisim için çağrıldığında
+        // eklemin cismin merkezine göre koordinatı (offset) kadar kaydırma
+        // yapılıp orijini cismin çizilmesi gereken noktaya kaydırır.
+
+        glTranslated(
+            offsetOfJointToParent.x,
+            offsetOfJointToParent.y,
+            offsetOfJointToParent.z);
+
+        // Mevcut konumlar (matris) saklanarak draw metodu çağrılır.
+        // (Silindir çiziminde rotate ve translate yapıldığı için push-pop
+        // gerekli.)
+
+        if (visible && !merged)
+        {
+            glPushMatrix();
+            this->draw();
+            glPopMatrix();
+        }
+
+        // Cismin çizimi bu noktada bitmiştir. Mevcut konum çizilmiş cismin
+        // ortasını gösteriyordur.
+
+        // Bu metod cismin çizimi bittiğinde bağlı cisimler için tekrar bu
+        // fonksiyonu çağırır. Ancak önce eklem noktasına ilerler.
+
+        // Aşağıdaki for döngüsü cisme bağlı cisim sayısı kadar tekrarlanır.
+        // Örneğin gövde için bağlı cisimler sol-omuz, sağ-omuz, sol-kalça,
+        // sağ-kalça ve boyundur. Yani 5 döngü gerçekleşir. Tabi sol-omuz için
+        // bu fonksiyon çağrıldığında ona bağlı olan 1 cisim vardır(sol-kol).
+        // Sonra sol-dirsek, sol-önkol için çağrılır ve çağrılar sonlanıp
+        // sağ-omuza(ikinci döngü) geçer.
+
+        for (unsigned int i = 0, length = this->children.size(); i < length; i++)
+        {
+            // Alt ağacı tamamen birleşik mesh'le çizilmiş olan cisim atlanır.
+            if (this->children[i]->mergedSubtree)
+                continue;
+
+            // Bir cisme bağlı birden fazla eklem olabileceği için her
+            // eklem için kaydırma yapmadan önce currentmatrix saklanıyor
+            // ve bir sonraki ekleme geçilmeden önce pop ile saklı matrix'e
+            // geri dönülüyor.
+
+            glPushMatrix();
+
+            // Bağlı cismin bağlanma noktasına kaydırma.
+            Coordinates offsets = this->jointOffsets[i];
+            glTranslated(offsets.x, offsets.y, offsets.z);
+
+            // Cismin bağlanma açısı (eklem açısı)
+            // 3 eksende dönme yapılıyor
+            Angles angles = *this->children[i]->joint;
+            glRotated(angles.x, 1, 0, 0);
+            glRotated(angles.y, 0, 1, 0);
+            glRotated(angles.z, 0, 0, 1);
+
+            // Bu noktada çizilen cisim ile çizilecek cismin
+            // kesişme noktasına translate ve eklem açısına rotate
+            // ile gelindi. Çizilecek cisim için aynı metod çağrılıyor.
+
+            this->children[i]->update();
+
+            // Daha fazla birbirine uç uca bağlı cisim kalmadığında
+            // aynı cisme bağlı birden fazla cisim olabileceği için pop
+            // yapılıyor ve saklı konuma dönülüyor.
+            glPopMatrix();
+        }
+
+        return;
+    }
+
+    // Skeleton sınıfının cismi düzleştirirken ihtiyaç duyduğu bilgiler
+
+    const Mesh *getMesh(void)
+    {
+        return rigid ? rigidLods[lod] : lods[lod];
+    }
+    const Mesh *getLodMesh(int level)
+    {
+        return rigid ? rigidLods[level] : lods[level];
+    }
+    const Mesh *getOwnMesh(int level)
+    {
+        // Birleştirmeden bağımsız olarak cismin kendi mesh'i
+        return lods[level];
+    }
+    int getLod(void)
+    {
+        return lod;
+    }
+    void setLod(int level)
+    {
+        lod = level;
+    }
+    double getBoundingRadius(void)
+    {
+        return rigid ? rigidRadius : boundingRadius;
+    }
+    double getLodRadius(void)
+    {
+        // Ayrıntı seviyesi birleşik mesh'te de kökün kendi boyuyla
+        // seçilir (bkz. Skeleton::mergeRigid)
+        return boundingRadius;
+    }
+    bool isVisible(void)
+    {
+        return visible;
+    }
+    void setVisibility(bool visible, bool subtreeVisible)
+    {
+        this->visible = visible;
+        this->subtreeVisible = subtreeVisible;
+    }
+    RGBA getColor(void)
+    {
+        // Birleşik mesh'in renkleri köşelerindedir; cismin rengi
+        // onlarla çarpılacağı için beyaz verilir.
+        if (rigid)
+        {
+            RGBA white = {1, 1, 1, color.alpha};
+            return white;
+        }
+        return color;
+    }
+    RGBA getOwnColor(void)
+    {
+        return color;
+    }
+    void setRigid(const Mesh *const *meshes, double radius)
+    {
+        // meshes NULL ise cisim yeniden tek başına çizilir
+        rigid = meshes != NULL;
+        rigidRadius = radius;
+        for (int level = 0; level < LOD_LEVELS; level++)
+            rigidLods[level] = meshes ? meshes[level] : NULL;
+    }
+    void setMerged(bool merged, bool mergedSubtree)
+    {
+        this->merged = merged;
+        this->mergedSubtree = mergedSubtree;
+    }
+    bool isRigid(void)
+    {
+        return rigid;
+    }
+    bool isMerged(void)
+    {
+        return merged;
+    }
+    bool isSubtreeMerged(void)
+    {
+        return mergedSubtree;
+    }
+    Coordinates getOffsetOfJointToParent(void)
+    {
+        return offsetOfJointToParent;
+    }
+    Matrix4 getInnerMatrix(void)
+    {
+        // draw metodunun, cismin merkezinden sonra yaptığı
+        // iç döndürme ve silindiri orta noktaya kaydırma
+        if (shape != CYLINDER)
+            return identityMatrix();
+        return rotationMatrix(rotate.x, X) *
+               rotationMatrix(rotate.y, Y) *
+               rotationMatrix(rotate.z, Z) *
+               translationMatrix(0, 0, -dim2 / 2);
+    }
+};
+
+/////////////////////////////////////////////////////////////////// İSKELET (İLERİ KİNEMATİK)
+
+/*
+Skeleton, Object::link ile kurulan parent-child ağacını bir kere
+düzleştirir: her cisim kendi parent'ından sonra gelecek şekilde
+(derinlik öncelikli sırada) bir diziye yazılır. Her karede
+evaluate metodu tüm cisimlerin dünya matrislerini özyineleme ve
+OpenGL matris yığını olmadan tek bir döngüde hesaplar.
+
+Eklemin üç Euler dönmesi (glRotated x3) ve iki ofset kaydırması
+tek bir yerel matriste birleştirilir:
+
+    yerel = T(eklem ofseti) * Rx * Ry * Rz * T(cismin eklem ofseti)
+    dünya = dünya(parent) * yerel
+
+Çizim bu matrisleri okur; seçme, görünmezlik testi veya dışa
+aktarma için eklemlerin dünya koordinatları da buradan alınır.
+
+Açısı hiç yazılmayan eklemler parçalarını birbirine göre sabit tutar.
+mergeRigid, böyle eklemlerle bağlı alt ağaçların (baş, boyun ve gözler
+gibi) mesh'lerini alt ağacın köküne göre bir kere taşıyıp her ayrıntı
+seviyesi için tek mesh'te birleştirir; köke katılan cisimler ayrıca
+seçilmez ve çizilmez, alt ağacı tamamen birleşmiş olanların dünya
+matrisleri de hesaplanmaz (toplu iskelet hesabında, SkeletonBatch'te
+de). Birleştirme isteğe bağlıdır (--rigid-merge): çizim çağrısı ve
+eklem hesabı azalır ama ayrıntı seviyesi grup başına seçildiği için
+görüntü biraz değişir. Animasyonların
+sürdüğü eklemler (bkz. Human::init) ve sonradan yazılan her eklem
+(drive) bir alt ağacın köküdür; yazılan eklem bir birleşik mesh'in
+içindeyse birleştirme yeniden yapılır.
+*/
+
+class Skeleton
+{
+private:
+    // Cisimler ve parent indeksleri (kök için -1)
+    std::vector<Object *> nodes;
+    std::vector<int> parents;
+
+    // Cismin eklem ofsetinin parent'ın jointOffsets dizisindeki sırası
+    std::vector<int> joints;
+
+    // Modelin pozu: her cismi parent'ına bağlayan eklemin açıları,
+    // cisim sırasıyla tek dizide (kökün açısı kullanılmaz, hep 0).
+    // Cisimlerin joint pointer'ları bu diziyi gösterir.
+    std::vector<Angles> pose;
+
+    // Cismin iç dönüşümü (bkz. Object::getInnerMatrix), bir kere hesaplanır
+    std::vector<Matrix4> innerMatrices;
+
+    std::vector<Matrix4> worlds;
+
+    // Her cismin alt ağacının (kendisi ve bağlı tüm cisimler) dizideki
+    // bitişi; derinlik öncelikli sırada alt ağaç [i, subtreeEnds[i])
+    // aralığıdır.
+    std::vector<int> subtreeEnds;
+
+    // evaluate ile güncellenen alt ağaç sınır küreleri. Merkez cismin
+    // kendi merkezidir, yarıçap tüm alt ağacı kapsar.
+    std::vector<double> subtreeRadii;
+
+    // Açısı yazılan (veya animasyonların sürdüğü) eklemler ve
+    // birleştirmenin açık olup olmadığı
+    std::vector<unsigned char> driven;
+    bool merging;
+
+    void updateBounds(void)
+    {
+        // Ters sırada gidildiğinde çocuklar parent'tan önce
+        // tamamlanır; her çocuğun küresi parent'ın küresine katılır.
+        // (Birleşen cisimler kökün yarıçapında zaten vardır.)
+        for (int i = 0, length = nodes.size(); i < length; i++)
+            subtreeRadii[i] = nodes[i]->getBoundingRadius();
+        for (int i = nodes.size() - 1; i > 0; i--)
+        {
+            if (nodes[i]->isSubtreeMerged())
+                continue;
+            int parent = parents[i];
+            double dx = worlds[i].m[12] - worlds[parent].m[12];
+            double dy = worlds[i].m[13] - worlds[parent].m[13];
+            double dz = worlds[i].m[14] - worlds[parent].m[14];
+            double reach = std::sqrt(dx * dx + dy * dy + dz * dz) + subtreeRadii[i];
+            subtreeRadii[parent] = std::max(subtreeRadii[parent], reach);
+        }
+    }
+
+    static void eulerMatrix(Matrix4 &r, Angles angles)
+    {
+        // Rx * Ry * Rz çarpımının kapalı hali (3x3 kısım)
+        double cx = std::cos(angles.x * PI / 180.0), sx = std::sin(angles.x * PI / 180.0);
+        double cy = std::cos(angles.y * PI / 180.0), sy = std::sin(angles.y * PI / 180.0);
+        double cz = std::cos(angles.z * PI / 180.0), sz = std::sin(angles.z * PI / 180.0);
+
+        r.m[0] = cy * cz;
+        r.m[1] = sx * sy * cz + cx * sz;
+        r.m[2] = -cx * sy * cz + sx * sz;
+        r.m[4] = -cy * sz;
+        r.m[5] = -sx * sy * sz + cx * cz;
+        r.m[6] = cx * sy * sz + sx * cz;
+        r.m[8] = sy;
+        r.m[9] = -sx * cy;
+        r.m[10] = cx * cy;
+        r.m[3] = r.m[7] = r.m[11] = 0;
+        r.m[15] = 1;
+    }
+    void localMatrix(int i, Matrix4 &local)
+    {
+        // Cismin parent'ının merkezine göre matrisi (kök dışında)
+        Coordinates childOffset = nodes[i]->getOffsetOfJointToParent();
+        Object *parent = nodes[parents[i]];
+        eulerMatrix(local, pose[i]);
+
+        // Çocuğun ofseti dönmeden sonra uygulandığı için
+        // dönme matrisinden geçirilerek eklem ofsetine eklenir.
+        Coordinates jointOffset = parent->jointOffsets[joints[i]];
+        local.m[12] = jointOffset.x + local.m[0] * childOffset.x + local.m[4] * childOffset.y + local.m[8] * childOffset.z;
+        local.m[13] = jointOffset.y + local.m[1] * childOffset.x + local.m[5] * childOffset.y + local.m[9] * childOffset.z;
+        local.m[14] = jointOffset.z + local.m[2] * childOffset.x + local.m[6] * childOffset.y + local.m[10] * childOffset.z;
+    }
+    void unmerge(void)
+    {
+        for (int i = 0, length = nodes.size(); i < length; i++)
+        {
+            nodes[i]->setRigid(NULL, 0);
+            nodes[i]->setMerged(false, false);
+            innerMatrices[i] = nodes[i]->getInnerMatrix();
+        }
+    }
+    void mergeRigid(void)
+    {
+        // Her cisim, açısı yazılan ilk atasının (veya kendisinin) alt
+        // ağacına katılır. Birden fazla cisimli her alt ağacın her
+        // seviyesi için cisimler köke göre matrisleriyle birleştirilir.
+        unmerge();
+        int count = nodes.size();
+        std::vector<int> groupRoots(count);
+        std::vector<Matrix4> relatives(count);
+        std::vector<double> reaches(count);
+        for (int i = 0; i < count; i++)
+        {
+            reaches[i] = nodes[i]->getLodRadius();
+            if (parents[i] < 0 || driven[i])
+            {
+                groupRoots[i] = i;
+                relatives[i] = identityMatrix();
+                continue;
+            }
+            groupRoots[i] = groupRoots[parents[i]];
+            Matrix4 local;
+            localMatrix(i, local);
+            multiplyAffine(relatives[parents[i]], local, relatives[i]);
+        }
+
+        // Kökün yarıçapı, updateBounds'un bu pozda alt ağaç için
+        // bulacağı yarıçaptır.
+        for (int i = count - 1; i > 0; i--)
+        {
+            int parent = parents[i];
+            if (groupRoots[i] != groupRoots[parent])
+                continue;
+            double dx = relatives[i].m[12] - relatives[parent].m[12];
+            double dy = relatives[i].m[13] - relatives[parent].m[13];
+            double dz = relatives[i].m[14] - relatives[parent].m[14];
+            reaches[parent] = std::max(reaches[parent], std::sqrt(dx * dx + dy * dy + dz * dz) + reaches[i]);
+        }
+
+        for (int root = 0; root < count; root++)
+        {
+            if (groupRoots[root] != root)
+                continue;
+            std::vector<int> members;
+            for (int i = root; i < subtreeEnds[root]; i++)
+                if (groupRoots[i] == root)
+                    members.push_back(i);
+            if (members.size() < 2)
+                continue;
+
+            // Birleşik mesh'in seviyesi kökün kendi yarıçapıyla seçilir.
+            // Her seviyede cisimler, kök o seviyenin en büyük
+            // yarıçapındayken kendi boylarına göre seçilecek seviyeyle
+            // eklenir (0. seviyenin üst sınırı yoktur); böylece her
+            // cisim ayrı çizildiğindeki kadar ayrıntıyla çizilir.
+            double rootRadius = std::max(nodes[root]->getLodRadius(), 1e-6);
+            const Mesh *meshes[LOD_LEVELS];
+            for (int level = 0; level < LOD_LEVELS; level++)
+            {
+                std::vector<const Mesh *> parts;
+                std::vector<Matrix4> matrices;
+                std::vector<RGBA> colors;
+                for (size_t k = 0; k < members.size(); k++)
+                {
+                    Object *member = nodes[members[k]];
+                    int memberLevel = level == 0 ? 0 : selectLodLevel(lodPixelRadius[level - 1] * member->getLodRadius() / rootRadius, LOD_LEVELS - 1);
+                    Matrix4 matrix;
+                    multiplyAffine(relatives[members[k]], member->getInnerMatrix(), matrix);
+                    parts.push_back(member->getOwnMesh(memberLevel));
+                    matrices.push_back(matrix);
+                    colors.push_back(member->getOwnColor());
+                }
+                meshes[level] = meshCache.getMerged(parts, matrices, colors);
+            }
+
+            nodes[root]->setRigid(meshes, reaches[root]);
+            innerMatrices[root] = identityMatrix();
+            for (size_t k = 1; k < members.size(); k++)
+            {
+                int member = members[k];
+                bool subtree = true;
+                for (int i = member; i < subtreeEnds[member] && subtree; i++)
+                    subtree = groupRoots[i] == root;
+                nodes[member]->setMerged(true, subtree);
+            }
+        }
+    }
+
+public:
+    static void multiplyAffine(const Matrix4 &l, const Matrix4 &r, Matrix4 &result)
+    {
+        // Son satırı (0, 0, 0, 1) olan matrislerin çarpımı
+        for (int column = 0; column < 4; column++)
+        {
+            for (int row = 0; row < 3; row++)
+                result.m[column * 4 + row] =
+                    l.m[row] * r.m[column * 4] +
+                    l.m[4 + row] * r.m[column * 4 + 1] +
+                    l.m[8 + row] * r.m[column * 4 + 2];
+            result.m[column * 4 + 3] = column == 3 ? 1 : 0;
+        }
+        for (int row = 0; row < 3; row++)
+            result.m[12 + row] += l.m[12 + row];
+    }
+
+    void build(Object &root)
+    {
+        // Özyinelemesiz derinlik öncelikli dolaşma; çocuklar yığına
+        // ters sırada konduğu için Object::update ile aynı sıra çıkar.
+        nodes.clear();
+        parents.clear();
+        joints.clear();
+        innerMatrices.clear();
+
+        std::vector<int> stackParents, stackJoints;
+        stackParents.push_back(-1);
+        stackJoints.push_back(-1);
+        std::vector<Object *> pending(1, &root);
+
+        while (!pending.empty())
+        {
+            Object *object = pending.back();
+            int parent = stackParents.back();
+            int joint = stackJoints.back();
+            pending.pop_back();
+            stackParents.pop_back();
+            stackJoints.pop_back();
+
+            int index = nodes.size();
+            nodes.push_back(object);
+            parents.push_back(parent);
+            joints.push_back(joint);
+            innerMatrices.push_back(object->getInnerMatrix());
+
+            for (int i = (int)object->children.size() - 1; i >= 0; i--)
+            {
+                pending.push_back(object->children[i]);
+                stackParents.push_back(index);
+                stackJoints.push_back(i);
+            }
+        }
+
+        worlds.assign(nodes.size(), identityMatrix());
+        subtreeRadii.assign(nodes.size(), 0);
+        driven.assign(nodes.size(), 0);
+        merging = false;
+
+        // Eklem açıları poz dizisine taşınır; bundan sonra açılar
+        // cisimler üzerinden de bu diziden okunur.
+        pose.resize(nodes.size());
+        for (unsigned int i = 0; i < nodes.size(); i++)
+        {
+            pose[i] = nodes[i]->bindAngles;
+            if (parents[i] < 0)
+                pose[i].x = pose[i].y = pose[i].z = 0;
+            nodes[i]->joint = &pose[i];
+        }
+
+        subtreeEnds.resize(nodes.size());
+        for (unsigned int i = 0; i < nodes.size(); i++)
+            subtreeEnds[i] = i + 1;
+        for (int i = nodes.size() - 1; i > 0; i--)
+            subtreeEnds[parents[i]] = std::max(subtreeEnds[parents[i]], subtreeEnds[i]);
+    }
+
+    void evaluate(const Matrix4 &rootMatrix)
+    {
+        // Parent her zaman çocuğundan önce geldiği için tek döngü
+        // yeterlidir.
+        Matrix4 local;
+        for (unsigned int i = 0, length = nodes.size(); i < length; i++)
+        {
+            if (parents[i] < 0)
+            {
+                Coordinates childOffset = nodes[i]->getOffsetOfJointToParent();
+                Matrix4 offset = translationMatrix(childOffset.x, childOffset.y, childOffset.z);
+                multiplyAffine(rootMatrix, offset, worlds[i]);
+                continue;
+            }
+            if (nodes[i]->isSubtreeMerged())
+                continue;
+
+            localMatrix(i, local);
+            multiplyAffine(worlds[parents[i]], local, worlds[i]);
+        }
+
+        updateBounds();
+    }
+
+    void cull(const Frustum &frustum)
+    {
+        // Alt ağacın küresi görüş alanının dışındaysa alt ağacın
+        // tamamı görünmez işaretlenir ve içine girilmez.
+        for (int i = 0, length = nodes.size(); i < length;)
+        {
+            if (nodes[i]->isSubtreeMerged())
+            {
+                nodes[i]->setVisibility(false, false);
+                i++;
+                continue;
+            }
+            Coordinates center = getPosition(i);
+            if (!frustum.containsSphere(center, subtreeRadii[i]))
+            {
+                for (int j = i; j < subtreeEnds[i]; j++)
+                    nodes[j]->setVisibility(false, false);
+                i = subtreeEnds[i];
+                continue;
+            }
+            nodes[i]->setVisibility(!nodes[i]->isMerged() && frustum.containsSphere(center, nodes[i]->getBoundingRadius()), true);
+            i++;
+        }
+    }
+
+    void setMerging(bool enabled)
+    {
+        // Sabit alt ağaçların birleştirilmesini açar veya kapatır
+        merging = enabled;
+        if (merging)
+            mergeRigid();
+        else
+            unmerge();
+    }
+    bool isMerging(void)
+    {
+        return merging;
+    }
+    void drive(int node)
+    {
+        // Eklemin açısı artık değişebilir; birleşik bir mesh'in içinde
+        // kalıyorsa alt ağaçlar yeniden kurulur.
+        if (node <= 0 || driven[node])
+            return;
+        driven[node] = 1;
+        if (merging && nodes[node]->isMerged())
+            mergeRigid();
+    }
+    bool isDriven(int node)
+    {
+        return driven[node] != 0;
+    }
+
+    int size(void)
+    {
+        return nodes.size();
+    }
+    Object *getNode(int node)
+    {
+        return nodes[node];
+    }
+    int getParent(int node)
+    {
+        return parents[node];
+    }
+    const Matrix4 &getWorldMatrix(int node)
+    {
+        return worlds[node];
+    }
+    double getSubtreeRadius(int node)
+    {
+        return subtreeRadii[node];
+    }
+    Matrix4 getMeshMatrix(int node)
+    {
+        // Cismin çizileceği matris (dünya matrisi * iç dönüşüm)
+        Matrix4 result;
+        multiplyAffine(worlds[node], innerMatrices[node], result);
+        return result;
+    }
+    Coordinates getPosition(int node)
+    {
+        // Cismin merkezinin (eklem noktasının değil) dünya koordinatı
+        Coordinates position = {worlds[node].m[12], worlds[node].m[13], worlds[node].m[14]};
+        return position;
+    }
+    void writeBoneRows(int node, GLfloat *target)
+    {
+        // Tek mesh'li çizimin kemik dokusuna mesh matrisinin ilk üç
+        // satırı (bkz. BufferRenderer::drawSkinned)
+        Matrix4 mesh = getMeshMatrix(node);
+        for (int row = 0; row < 3; row++)
+            for (int column = 0; column < 4; column++)
+                target[row * 4 + column] = mesh.m[column * 4 + row];
+    }
+
+    // SkeletonBatch'in iskeleti kopyalarken ihtiyaç duyduğu bilgiler
+
+    Angles getJointAngles(int node)
+    {
+        // Cismi parent'ına bağlayan eklemin açıları (kök için 0)
+        return pose[node];
+    }
+    Angles *getPose(void)
+    {
+        // Tüm eklem açıları, cisim sırasıyla (size() eleman)
+        return &pose[0];
+    }
+    int findNode(const Object *object)
+    {
+        // Cismin dizideki sırası, iskelette yoksa -1
+        for (int i = 0, length = nodes.size(); i < length; i++)
+            if (nodes[i] == object)
+                return i;
+        return -1;
+    }
+    Coordinates getJointOffset(int node)
+    {
+        // Eklemin parent'ın merkezine göre koordinatı (kök için 0)
+        if (parents[node] < 0)
+        {
+            Coordinates zero = {0, 0, 0};
+            return zero;
+        }
+        return nodes[parents[node]]->jointOffsets[joints[node]];
+    }
+    const Matrix4 &getInnerMatrix(int node)
+    {
+        return innerMatrices[node];
+    }
+};
+
+/////////////////////////////////////////////////////////////////// TOPLU İSKELET HESABI (SIMD)
+
+/*
+SkeletonBatch aynı iskelete sahip birçok modelin ileri kinematiğini
+birlikte hesaplar. Veriler yapıların dizisi yerine dizilerin yapısı
+(SoA) şeklinde tutulur: bir eklemin X açısı tüm modeller için yan
+yana durur. Böylece aynı eklem SKELETON_LANES (8) modelde tek
+seferde hesaplanır.
+
+GCC/Clang'ın vektör tipleriyle yazılan çekirdek, x86-64 Linux'ta
+AVX (8 model/komut) ve SSE (4 model/komut) için ayrı ayrı derlenir;
+hangisinin kullanılacağına işlemciye bakılarak çalışma anında karar
+verilir. Vektör tipleri olmayan derleyicilerde veya useSimd kapalıyken
+aynı hesap skaler döngüyle yapılır.
+
+Matrisler 12 float olarak saklanır: 3x3 dönme kısmı sütun sütun,
+ardından öteleme. (Son satır her zaman 0, 0, 0, 1)
+*/
+
+#define SKELETON_LANES 8
+
+#if defined(__GNUC__)
+#define SKELETON_SIMD 1
+typedef float LaneFloats __attribute__((vector_size(SKELETON_LANES * sizeof(float))));
+typedef int LaneInts __attribute__((vector_size(SKELETON_LANES * sizeof(int))));
+#if defined(__x86_64__) && defined(__linux__)
+#define SKELETON_TARGETS __attribute__((target_clones("avx", "default")))
+#else
+#define SKELETON_TARGETS
+#endif
+// Yardımcılar çekirdeğin içine açılır; vektörler değer olarak
+// geçirilmediği için AVX olmayan derlemede ABI farkı oluşmaz.
+#define LANE_INLINE static inline __attribute__((always_inline))
+
+LANE_INLINE void loadLanes(LaneFloats &v, const float *source)
+{
+    memcpy(&v, source, sizeof(v));
+}
+LANE_INLINE void storeLanes(float *target, const LaneFloats &v)
+{
+    memcpy(target, &v, sizeof(v));
+}
+LANE_INLINE void selectLanes(LaneFloats &result, const LaneInts &mask, const LaneFloats &a, const LaneFloats &b)
+{
+    // mask'ın -1 olduğu kanallarda a, 0 olduğu kanallarda b
+    result = (LaneFloats)(((LaneInts)a & mask) | ((LaneInts)b & ~mask));
+}
+LANE_INLINE void sinCosLanes(const LaneFloats &degrees, LaneFloats &sine, LaneFloats &cosine)
+{
+    // Açı 90 derecenin en yakın katına göre [-45, 45] aralığına
+    // indirilir, bu aralıkta polinomla hesaplanır ve çeyreğe göre
+    // sin/cos yer değiştirip işaret alır.
+    LaneFloats quarters = degrees * (float)(1.0 / 90.0) + 0.5f;
+    LaneInts n = __builtin_convertvector(quarters, LaneInts);
+    n += (LaneInts)(__builtin_convertvector(n, LaneFloats) > quarters); // floor
+    LaneFloats r = (degrees - __builtin_convertvector(n, LaneFloats) * 90.0f) * (float)(PI / 180.0);
+
+    LaneFloats r2 = r * r;
+    LaneFloats s = r * (1.0f + r2 * (-1.6666667e-1f + r2 * (8.3333333e-3f + r2 * (-1.9841270e-4f + r2 * 2.7557319e-6f))));
+    LaneFloats c = 1.0f + r2 * (-0.5f + r2 * (4.1666667e-2f + r2 * (-1.3888889e-3f + r2 * 2.4801587e-5f)));
+
+    LaneInts swap = (n & 1) != 0;
+    LaneInts sineNegative = (n & 2) != 0;
+    LaneInts cosineNegative = ((n + 1) & 2) != 0;
+    LaneInts sign = LaneInts() - 2147483647 - 1; // sadece işaret biti (0x80000000)
+    selectLanes(sine, swap, c, s);
+    selectLanes(cosine, swap, s, c);
+    sine = (LaneFloats)((LaneInts)sine ^ (sign & sineNegative));
+    cosine = (LaneFloats)((LaneInts)cosine ^ (sign & cosineNegative));
+}
+
+static SKELETON_TARGETS void evaluateSkeletonLanes(
+    int nodeCount, int lanes, int firstLane, int lastLane,
+    const int *parents, const unsigned char *skipped, const float *offsets, const float *inners,
+    const float *angles, const float *roots, float *worlds, float *meshes)
+{
+    // [firstLane, lastLane) aralığındaki modeller hesaplanır (sınırlar
+    // SKELETON_LANES'in katı). Dış döngü cisimler üzerinde olduğu için
+    // her dizi sırayla okunup yazılır. (Parent her zaman önce hesaplanmıştır.)
+    // skipped işaretli cisimler (birleşik alt ağaçlar) hesaplanmaz.
+    for (int node = 0; node < nodeCount; node++)
+    {
+        if (skipped[node])
+            continue;
+        for (int lane = firstLane; lane < lastLane; lane += SKELETON_LANES)
+        {
+            const float *parentWorld = parents[node] < 0 ? roots : worlds + parents[node] * 12 * lanes;
+            const float *offset = offsets + node * 6;
+            LaneFloats p[12], r[9], t[3], w[12];
+            for (int k = 0; k < 12; k++)
+                loadLanes(p[k], parentWorld + k * lanes + lane);
+
+            if (parents[node] < 0)
+            {
+                // Kök cisim: sadece kendi ofseti kadar kaydırma
+                for (int k = 0; k < 9; k++)
+                    r[k] = LaneFloats() + (k % 4 == 0 ? 1.0f : 0.0f);
+                for (int k = 0; k < 3; k++)
+                    t[k] = LaneFloats() + offset[3 + k];
+            }
+            else
+            {
+                // Rx * Ry * Rz (bkz. Skeleton::eulerMatrix)
+                const float *angle = angles + node * 3 * lanes + lane;
+                LaneFloats ax, ay, az, sx, cx, sy, cy, sz, cz;
+                loadLanes(ax, angle);
+                loadLanes(ay, angle + lanes);
+                loadLanes(az, angle + 2 * lanes);
+                sinCosLanes(ax, sx, cx);
+                sinCosLanes(ay, sy, cy);
+                sinCosLanes(az, sz, cz);
+
+                r[0] = cy * cz;
+                r[1] = sx * sy * cz + cx * sz;
+                r[2] = -cx * sy * cz + sx * sz;
+                r[3] = -cy * sz;
+                r[4] = -sx * sy * sz + cx * cz;
+                r[5] = cx * sy * sz + sx * cz;
+                r[6] = sy;
+                r[7] = -sx * cy;
+                r[8] = cx * cy;
+                for (int row = 0; row < 3; row++)
+                    t[row] = offset[row] + r[row] * offset[3] + r[3 + row] * offset[4] + r[6 + row] * offset[5];
+            }
+
+            // dünya = parent * yerel
+            for (int row = 0; row < 3; row++)
+            {
+                for (int column = 0; column < 3; column++)
+                    w[column * 3 + row] = p[row] * r[column * 3] + p[3 + row] * r[column * 3 + 1] + p[6 + row] * r[column * 3 + 2];
+                w[9 + row] = p[9 + row] + p[row] * t[0] + p[3 + row] * t[1] + p[6 + row] * t[2];
+            }
+
+            // mesh = dünya * iç dönüşüm
+            float *world = worlds + node * 12 * lanes + lane;
+            float *mesh = meshes + node * 12 * lanes + lane;
+            const float *inner = inners + node * 12;
+            for (int row = 0; row < 3; row++)
+            {
+                for (int column = 0; column < 4; column++)
+                {
+                    LaneFloats v = w[row] * inner[column * 3] + w[3 + row] * inner[column * 3 + 1] + w[6 + row] * inner[column * 3 + 2];
+                    if (column == 3)
+                        v += w[9 + row];
+                    storeLanes(mesh + (column * 3 + row) * lanes, v);
+                }
+            }
+            for (int k = 0; k < 12; k++)
+                storeLanes(world + k * lanes, w[k]);
+        }
+    }
+}
+#endif
+
+// İşçilere dağıtılan model grubunun boyu (SKELETON_LANES'in katı;
+// 64 float, her dizide tam önbellek satırlarına denk gelir)
+#define SKELETON_BATCH_GRAIN 64
+
+// Oturum kaydında ve tekrarında pozların karşılaştırılması için (FNV-1a)
+#define HASH_SEED 14695981039346656037ULL
+
+static unsigned long long hashBytes(unsigned long long hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+class SkeletonBatch
+{
+private:
+    int nodeCount, rigCount, lanes;
+
+    // Tüm modellerde ortak olan iskelet bilgileri. skipped, alt ağacı
+    // bir üst cismin birleşik mesh'ine katılmış (hesaplanmayan, matrisleri
+    // kullanılmayan) cisimleri işaretler (bkz. Skeleton::evaluate).
+    std::vector<int> parents;
+    std::vector<unsigned char> skipped;
+    std::vector<float> offsets; // cisim başına eklem ofseti (3) + cismin ofseti (3)
+    std::vector<float> inners;  // cisim başına iç dönüşüm (12)
+
+    // [cisim][eksen][model] açılar (derece), [12][model] kök matrisleri,
+    // [cisim][12][model] dünya ve mesh matrisleri
+    std::vector<float> angles;
+    std::vector<float> roots;
+    std::vector<float> worlds;
+    std::vector<float> meshes;
+
+    static void compact(const Matrix4 &matrix, float *target, int stride)
+    {
+        static const int indices[12] = {0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14};
+        for (int k = 0; k < 12; k++)
+            target[k * stride] = matrix.m[indices[k]];
+    }
+    static Matrix4 expand(const float *source, int stride)
+    {
+        static const int indices[12] = {0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14};
+        Matrix4 matrix = identityMatrix();
+        for (int k = 0; k < 12; k++)
+            matrix.m[indices[k]] = source[k * stride];
+        return matrix;
+    }
+
+public:
+    // false ise SIMD çekirdeği yerine skaler döngü kullanılır
+    bool useSimd;
+
+    SkeletonBatch(void)
+    {
+        nodeCount = rigCount = lanes = 0;
+        useSimd = true;
+    }
+
+    void build(Skeleton &skeleton, int rigCount)
+    {
+        // Model sayısı SKELETON_LANES'in katına yuvarlanır;
+        // artan kanallar sıfır açılarla boşa hesaplanır.
+        this->nodeCount = skeleton.size();
+        this->rigCount = rigCount;
+        this->lanes = (rigCount + SKELETON_LANES - 1) / SKELETON_LANES * SKELETON_LANES;
+
+        parents.resize(nodeCount);
+        skipped.resize(nodeCount);
+        offsets.resize(nodeCount * 6);
+        inners.resize(nodeCount * 12);
+        for (int node = 0; node < nodeCount; node++)
+        {
+            parents[node] = skeleton.getParent(node);
+            skipped[node] = skeleton.getNode(node)->isSubtreeMerged();
+            Coordinates jointOffset = skeleton.getJointOffset(node);
+            Coordinates childOffset = skeleton.getNode(node)->getOffsetOfJointToParent();
+            float *offset = &offsets[node * 6];
+            offset[0] = jointOffset.x;
+            offset[1] = jointOffset.y;
+            offset[2] = jointOffset.z;
+            offset[3] = childOffset.x;
+            offset[4] = childOffset.y;
+            offset[5] = childOffset.z;
+            compact(skeleton.getInnerMatrix(node), &inners[node * 12], 1);
+        }
+
+        angles.assign(nodeCount * 3 * lanes, 0);
+        roots.assign(12 * lanes, 0);
+        worlds.assign(nodeCount * 12 * lanes, 0);
+        meshes.assign(nodeCount * 12 * lanes, 0);
+    }
+
+    int size(void)
+    {
+        return rigCount;
+    }
+
+    void setRoot(int rig, const Matrix4 &matrix)
+    {
+        compact(matrix, &roots[rig], lanes);
+    }
+    void setJointAngles(int rig, int node, Angles jointAngles)
+    {
+        float *angle = &angles[node * 3 * lanes + rig];
+        angle[0] = jointAngles.x;
+        angle[lanes] = jointAngles.y;
+        angle[2 * lanes] = jointAngles.z;
+    }
+    void copyPose(int rig, Skeleton &skeleton)
+    {
+        // Bir modelin güncel eklem açılarını toplu diziye kopyalar
+        const Angles *pose = skeleton.getPose();
+        for (int node = 0; node < nodeCount; node++)
+            setJointAngles(rig, node, pose[node]);
+    }
+    unsigned long long hashPose(unsigned long long hash) const
+    {
+        // Tüm modellerin açıları ve kök matrisleri (hesaplanan
+        // matrisler bunlardan belirlenir)
+        if (!angles.empty())
+            hash = hashBytes(hash, &angles[0], angles.size() * sizeof(float));
+        if (!roots.empty())
+            hash = hashBytes(hash, &roots[0], roots.size() * sizeof(float));
+        return hash;
+    }
+
+    void evaluate(void)
+    {
+        // Modeller SKELETON_BATCH_GRAIN'lik gruplar halinde işçilere
+        // dağıtılır; her grup yalnızca kendi sütunlarına yazar.
+        workers.parallelFor(lanes, SKELETON_BATCH_GRAIN, [this](int first, int last) {
+            evaluateRange(first, last);
+        });
+    }
+    void evaluateRange(int first, int last)
+    {
+#ifdef SKELETON_SIMD
+        if (useSimd)
+        {
+            evaluateSkeletonLanes(
+                nodeCount, lanes, first, last, &parents[0], &skipped[0], &offsets[0], &inners[0],
+                &angles[0], &roots[0], &worlds[0], &meshes[0]);
+            return;
+        }
+#endif
+        evaluateScalar(first, last);
+    }
+
+    void evaluateScalar(void)
+    {
+        evaluateScalar(0, lanes);
+    }
+    void evaluateScalar(int first, int last)
+    {
+        // SIMD çekirdeğinin model model yapılan karşılığı
+        for (int rig = first; rig < last; rig++)
+        {
+            for (int node = 0; node < nodeCount; node++)
+            {
+                if (skipped[node])
+                    continue;
+                Matrix4 parent = parents[node] < 0
+                                     ? expand(&roots[rig], lanes)
+                                     : expand(&worlds[parents[node] * 12 * lanes + rig], lanes);
+                const float *offset = &offsets[node * 6];
+
+                Matrix4 local;
+                if (parents[node] < 0)
+                    local = translationMatrix(offset[3], offset[4], offset[5]);
+                else
+                {
+                    const float *angle = &angles[node * 3 * lanes + rig];
+                    local = translationMatrix(offset[0], offset[1], offset[2]) *
+                            rotationMatrix(angle[0], X) *
+                            rotationMatrix(angle[lanes], Y) *
+                            rotationMatrix(angle[2 * lanes], Z) *
+                            translationMatrix(offset[3], offset[4], offset[5]);
+                }
+
+                Matrix4 world, mesh;
+                Skeleton::multiplyAffine(parent, local, world);
+                Skeleton::multiplyAffine(world, expand(&inners[node * 12], 1), mesh);
+                compact(world, &worlds[node * 12 * lanes + rig], lanes);
+                compact(mesh, &meshes[node * 12 * lanes + rig], lanes);
+            }
+        }
+    }
+
+    Matrix4 getWorldMatrix(int rig, int node)
+    {
+        return expand(&worlds[node * 12 * lanes + rig], lanes);
+    }
+    Coordinates getPosition(int rig, int node)
+    {
+        // Cismin merkezinin dünya koordinatı (öteleme kısmı)
+        const float *world = &worlds[node * 12 * lanes + rig];
+        Coordinates position = {world[9 * lanes], world[10 * lanes], world[11 * lanes]};
+        return position;
+    }
+    Matrix4 getMeshMatrix(int rig, int node)
+    {
+        return expand(&meshes[node * 12 * lanes + rig], lanes);
+    }
+    void writeMeshMatrix(int rig, int node, GLfloat *target)
+    {
+        // Örnekli çizim tamponuna doğrudan 4x4 sütun öncelikli yazım
+        const float *mesh = &meshes[node * 12 * lanes + rig];
+        for (int column = 0; column < 4; column++)
+        {
+            for (int row = 0; row < 3; row++)
+                target[column * 4 + row] = mesh[(column * 3 + row) * lanes];
+            target[column * 4 + 3] = column == 3 ? 1 : 0;
+        }
+    }
+    void writeBoneRows(int rig, int node, GLfloat *target)
+    {
+        // Kemik dokusuna mesh matrisinin ilk üç satırı
+        const float *mesh = &meshes[node * 12 * lanes + rig];
+        for (int row = 0; row < 3; row++)
+            for (int column = 0; column < 4; column++)
+                target[row * 4 + column] = mesh[(column * 3 + row) * lanes];
+    }
+};
+
+/////////////////////////////////////////////////////////////////// İSKELET DOSYASI (RIG)
+
+/*
+Bir iskeletin parçaları, ölçüleri, renkleri, iç döndürmeleri ve
+eklemleri ikili bir dosyada saklanır. Dosya, başlıktan sonra sabit
+boyutlu düğüm kayıtlarından oluşur; belleğe eşlendikten (mmap) sonra
+kayıtlar hiç ayrıştırılmadan ve kopyalanmadan yerinde kullanılır.
+Sayılar makinenin (little-endian) düzenindedir.
+
+Her düğüm parent'ından sonra gelir; aynı parent'a bağlı düğümlerin
+sırası Object::link sırasıdır (ilk düğüm kök, yani gövdedir).
+
+İkili dosya, satır başına bir düğüm tanımlanan metin dosyasından
+--compile-rig ile üretilir (bkz. rigs/human.rig):
+
+    isim şekil parent  ölçü1 ölçü2 ölçü3  r g b  içX içY içZ
+         eklemX eklemY eklemZ  parentOfsetXYZ  çocukOfsetXYZ
+
+şekil: sphere, cylinder veya box; kök düğümün parent'ı "-"
+
+Dosya Human'ın sabit parçalarının ölçülerini ve bağlantılarını verir,
+yeni parça tanımlamaz: isimler rigPartNames'ten biri olmalı, her isim
+en fazla bir kez geçmeli ve kök gövde (body) olmalıdır. Parçalar başka
+parent'lara bağlanabilir veya dosyada hiç geçmeyebilir. Bu kurallara
+uymayan dosyalar derlenirken ve yüklenirken reddedilir.
+*/
+
+#define RIG_VERSION 1
+
+typedef struct rigHeader
+{
+    char magic[4]; // "BSMR"
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t nodeSize; // sizeof(RigNode), farklı derlemeleri ayırt etmek için
+} RigHeader;
+
+typedef struct rigNode
+{
+    char name[16];
+    int32_t shape;  // SPHERE, CYLINDER, RECTANGULARPRISM
+    int32_t parent; // parent düğümün sırası, kök için -1
+    double dimensions[3];
+    double color[3];
+    double rotate[3];
+    double jointAngles[3];
+    double parentOffset[3];
+    double childOffset[3];
+} RigNode;
+
+// Program içindeki varsayılan iskelet (rigs/human.rig ile aynı)
+
+static const RigNode defaultHumanRig[] = {
+    {"body", CYLINDER, -1, {0.5, 1.3, 0}, {1, 0.6, 0}, {90, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {"rightShoulder", SPHERE, 0, {0.1001, 0, 0}, {1, 0, 0}, {0, 0, 0}, {0, 0, 0}, {-0.5, 0.3, 0}, {0, 0, 0}},
+    {"rightArm", CYLINDER, 1, {0.1, 0.7, 0}, {0.12, 0.38, 0.25}, {0, 90, 0}, {0, 0, 6}, {0, 0, 0}, {-0.35, 0, 0}},
+    {"rightElbow", SPHERE, 2, {0.1001, 0, 0}, {1, 0, 0}, {0, 0, 0}, {0, 0, 0}, {-0.35, 0, 0}, {0, 0, 0}},
+    {"rightForearm", CYLINDER, 3, {0.1, 0.7, 0}, {1, 1, 0}, {0, 90, 0}, {0, 0, -90}, {0, 0, 0}, {-0.35, 0, 0}},
+    {"leftShoulder", SPHERE, 0, {0.1001, 0, 0}, {1, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0.5, 0.3, 0}, {0, 0, 0}},
+    {"leftArm", CYLINDER, 5, {0.1, 0.7, 0}, {0.12, 0.38, 0.25}, {0, 90, 0}, {0, 0, -6}, {0, 0, 0}, {0.35, 0, 0}},
+    {"leftElbow", SPHERE, 6, {0.1001, 0, 0}, {1, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0.35, 0, 0}, {0, 0, 0}},
+    {"leftForearm", CYLINDER, 7, {0.1, 0.7, 0}, {1, 1, 0}, {0, 90, 0}, {0, 0, 90}, {0, 0, 0}, {0.35, 0, 0}},
+    {"leftHip", SPHERE, 0, {0.1001, 0, 0}, {1, 0, 0}, {0, 0, 0}, {0, 0, -10}, {-0.2, -0.65, 0}, {0, 0, 0}},
+    {"leftFoot", CYLINDER, 9, {0.1, 1.0, 0}, {0.12, 0.38, 0.25}, {90, 0, 90}, {0, 0, 0}, {0, 0, 0}, {0, -0.5, 0}},
+    {"rightHip", SPHERE, 0, {0.1001, 0, 0}, {1, 0, 0}, {0, 0, 0}, {0, 0, 10}, {0.2, -0.65, 0}, {0, 0, 0}},
+    {"rightFoot", CYLINDER, 11, {0.1, 1.0, 0}, {0.12, 0.38, 0.25}, {90, 0, 90}, {0, 0, 0}, {0, 0, 0}, {0, -0.5, 0}},
+    {"neck", CYLINDER, 0, {0.1, 0.2, 0}, {0.13, 0.26, 1.0}, {90, 0, 0}, {0, 0, 0}, {0, 0.65, 0}, {0, 0.1, 0}},
+    {"head", SPHERE, 13, {0.5, 0, 0}, {1, 0.6, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0.1, 0}, {0, 0.5, 0}},
+    {"rightEyeOutside", SPHERE, 14, {0.1, 0, 0}, {1, 1, 1}, {0, 0, 0}, {0, 0, 0}, {-0.2, 0.1, 0.4}, {0, 0, 0}},
+    {"rightEyeInside", SPHERE, 15, {0.04, 0, 0}, {0.5, 0.3, 0.1}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {-0.01, 0.01, 0.1}},
+    {"leftEyeOutside", SPHERE, 14, {0.1, 0, 0}, {1, 1, 1}, {0, 0, 0}, {0, 0, 0}, {0.2, 0.1, 0.4}, {0, 0, 0}},
+    {"leftEyeInside", SPHERE, 17, {0.04, 0, 0}, {0.5, 0.3, 0.1}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0.01, 0.01, 0.1}}};
+
+// İskelet dosyasının tanıdığı parça isimleri; sıra Human::findPart'taki
+// tabloyla aynıdır ve ilk isim köktür.
+static const char *const rigPartNames[] = {
+    "body", "head", "neck",
+    "leftEyeOutside", "leftEyeInside", "leftArm", "leftForearm", "leftFoot",
+    "leftShoulder", "leftElbow", "leftHip",
+    "rightEyeOutside", "rightEyeInside", "rightArm", "rightForearm", "rightFoot",
+    "rightShoulder", "rightElbow", "rightHip"};
+
+#define RIG_PARTS (int)(sizeof(rigPartNames) / sizeof(rigPartNames[0]))
+
+static int rigPartIndex(const char *name)
+{
+    for (int part = 0; part < RIG_PARTS; part++)
+        if (strncmp(name, rigPartNames[part], sizeof(((RigNode *)0)->name)) == 0)
+            return part;
+    return -1;
+}
+
+// Düğümün ismi tanınmıyorsa, kendinden önceki bir düğümle aynıysa veya
+// kök olup olmaması gövde olup olmamasına uymuyorsa hatayı döndürür.
+static const char *rigNameError(const RigNode *nodes, int index)
+{
+    const RigNode &node = nodes[index];
+    int part = rigPartIndex(node.name);
+    if (part < 0)
+        return "tanınmayan parça";
+    for (int i = 0; i < index; i++)
+        if (rigPartIndex(nodes[i].name) == part)
+            return "aynı parça ikinci kez tanımlanmış";
+    if ((part == 0) != (node.parent < 0))
+        return "kök yalnızca gövde (body) olabilir";
+    return NULL;
+}
+
+class Rig
+{
+private:
+    // Kayıtlar ya program içindeki tabloyu ya da eşlenen dosyayı gösterir
+    const RigNode *nodes;
+    int count;
+
+    // Eşlenen dosya (mmap kullanılamayan yerlerde okunan kopya)
+    void *mapping;
+    size_t mappingSize;
+#ifdef _MSC_VER
+    std::vector<char> contents;
+#endif
+
+    void unmap(void)
+    {
+#ifndef _MSC_VER
+        if (mapping)
+            munmap(mapping, mappingSize);
+#endif
+        mapping = NULL;
+        mappingSize = 0;
+    }
+
+public:
+    Rig(void)
+    {
+        mapping = NULL;
+        mappingSize = 0;
+        useDefault();
+    }
+    ~Rig(void)
+    {
+        unmap();
+    }
+    Rig(const Rig &) = delete;
+    Rig &operator=(const Rig &) = delete;
+
+    void useDefault(void)
+    {
+        unmap();
+        nodes = defaultHumanRig;
+        count = sizeof(defaultHumanRig) / sizeof(defaultHumanRig[0]);
+    }
+    bool load(const std::string &path)
+    {
+        // Dosya belleğe eşlenir ve yalnızca başlık, parent sıraları ve
+        // isimler doğrulanır. Hata olursa varsayılan iskelet kalır.
+        useDefault();
+#ifndef _MSC_VER
+        int file = open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (file < 0 || fstat(file, &status) != 0)
+        {
+            if (file >= 0)
+                close(file);
+            std::cerr << "iskelet dosyası açılamadı: " << path << std::endl;
+            return false;
+        }
+        size_t size = status.st_size;
+        void *data = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+        close(file);
+        if (data == MAP_FAILED)
+        {
+            std::cerr << "iskelet dosyası eşlenemedi: " << path << std::endl;
+            return false;
+        }
+        mapping = data;
+        mappingSize = size;
+#else
+        std::ifstream file(path.c_str(), std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (!file && !file.eof())
+        {
+            std::cerr << "iskelet dosyası açılamadı: " << path << std::endl;
+            return false;
+        }
+        const char *data = contents.empty() ? NULL : &contents[0];
+        size_t size = contents.size();
+#endif
+
+        const RigHeader *header = (const RigHeader *)data;
+        bool valid = size >= sizeof(RigHeader) &&
+                     memcmp(header->magic, "BSMR", 4) == 0 &&
+                     header->version == RIG_VERSION &&
+                     header->nodeSize == sizeof(RigNode) &&
+                     header->nodeCount > 0 &&
+                     size >= sizeof(RigHeader) + (size_t)header->nodeCount * sizeof(RigNode);
+        const RigNode *fileNodes = (const RigNode *)((const char *)data + sizeof(RigHeader));
+        const char *nameError = NULL;
+        for (uint32_t i = 0; valid && i < header->nodeCount; i++)
+        {
+            valid = i == 0 ? fileNodes[i].parent == -1 : (fileNodes[i].parent >= 0 && (uint32_t)fileNodes[i].parent < i);
+            valid = valid && fileNodes[i].shape >= SPHERE && fileNodes[i].shape <= RECTANGULARPRISM;
+            if (valid && (nameError = rigNameError(fileNodes, i)) != NULL)
+            {
+                std::cerr << path << ": " << nameError << ": "
+                          << std::string(fileNodes[i].name, strnlen(fileNodes[i].name, sizeof(fileNodes[i].name))) << std::endl;
+                valid = false;
+            }
+        }
+        if (!valid)
+        {
+            std::cerr << "geçersiz iskelet dosyası: " << path << std::endl;
+            useDefault();
+            return false;
+        }
+
+        nodes = fileNodes;
+        count = header->nodeCount;
+        return true;
+    }
+    const RigNode *getNodes(void) const
+    {
+        return nodes;
+    }
+    int size(void) const
+    {
+        return count;
+    }
+};
+
+bool compileRig(const std::string &sourcePath, const std::string &outputPath)
+{
+    // Metin biçimindeki iskeleti ikili dosyaya çevirir
+    std::ifstream source(sourcePath.c_str());
+    if (!source)
+    {
+        std::cerr << "iskelet kaynağı açılamadı: " << sourcePath << std::endl;
+        return false;
+    }
+
+    std::vector<RigNode> nodes;
+    std::string line;
+    for (int lineNumber = 1; std::getline(source, line); lineNumber++)
+    {
+        // # sonrası açıklamadır, boş satırlar atlanır
+        std::string::size_type comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+        std::istringstream fields(line);
+        std::string name, shape, parent;
+        if (!(fields >> name))
+            continue;
+
+        RigNode node;
+        memset(&node, 0, sizeof(node));
+        double *values[6] = {node.dimensions, node.color, node.rotate, node.jointAngles, node.parentOffset, node.childOffset};
+        bool valid = (bool)(fields >> shape >> parent) && name.size() < sizeof(node.name);
+        for (int group = 0; group < 6 && valid; group++)
+            for (int k = 0; k < 3 && valid; k++)
+                valid = (bool)(fields >> values[group][k]);
+
+        strncpy(node.name, name.c_str(), sizeof(node.name) - 1);
+        if (shape == "sphere")
+            node.shape = SPHERE;
+        else if (shape == "cylinder")
+            node.shape = CYLINDER;
+        else if (shape == "box")
+            node.shape = RECTANGULARPRISM;
+        else
+            valid = false;
+
+        // Parent daha önce tanımlanmış olmalı; yalnızca ilk düğüm köktür
+        node.parent = -1;
+        for (int i = nodes.size() - 1; i >= 0 && parent != "-"; i--)
+            if (name != parent && parent == nodes[i].name)
+                node.parent = i;
+        if ((parent == "-") != nodes.empty() || (parent != "-" && node.parent < 0))
+            valid = false;
+
+        if (!valid)
+        {
+            std::cerr << sourcePath << ":" << lineNumber << ": geçersiz düğüm tanımı" << std::endl;
+            return false;
+        }
+        nodes.push_back(node);
+        const char *nameError = rigNameError(&nodes[0], nodes.size() - 1);
+        if (nameError)
+        {
+            std::cerr << sourcePath << ":" << lineNumber << ": " << nameError << ": " << name << std::endl;
+            return false;
+        }
+    }
+    if (nodes.empty())
+    {
+        std::cerr << sourcePath << ": düğüm tanımlanmamış" << std::endl;
+        return false;
+    }
+
+    RigHeader header;
+    memcpy(header.magic, "BSMR", 4);
+    header.version = RIG_VERSION;
+    header.nodeCount = nodes.size();
+    header.nodeSize = sizeof(RigNode);
+
+    std::ofstream output(outputPath.c_str(), std::ios::binary);
+    output.write((const char *)&header, sizeof(header));
+    output.write((const char *)&nodes[0], nodes.size() * sizeof(RigNode));
+    if (!output)
+    {
+        std::cerr << "iskelet dosyası yazılamadı: " << outputPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Human metodları herhangi bir vücut parçasının
+// bilgilerini (eklem açısı vs.) güncellemek istediğinde
+// Object sınıfının ilgili metoduna aşağıdaki sabitler ile
+// komut gönderir.
+
+#define BODY 0
+
+#define HEAD 1
+#define NECK 2
+#define LEFT_ARM 3
+#define LEFT_FOREARM 4
+#define LEFT_FOOT 5
+#define RIGHT_ARM 6
+#define RIGHT_FOREARM 7
+#define RIGHT_FOOT 8
+
+#define LEFT_SHOULDER 9
+#define LEFT_ELBOW 10
+#define LEFT_HIP 11
+#define RIGHT_SHOULDER 12
+#define RIGHT_ELBOW 13
+#define RIGHT_HIP 14
+
+/////////////////////////////////////////////////////////////////// ANİMASYON KLİBİ
+
+/*
+AnimationClip, setAngle ile sürülen eklem eksenlerinin (iz, track)
+anahtar karelerini saklar. Tüm izlerin anahtarları tek bir dizide art
+arda durur; her anahtar simülasyon adımı ve 16 bitlik nicemlenmiş açı
+olmak üzere 4 bayttır. Açı, izin en küçük ve en büyük değeri arasında
+nicemlenir; ara değerlemeyle verilen tolerans içinde kalan anahtarlar
+klip kurulurken atılır ve izin gerçek hatası maxError'da saklanır.
+
+Klip döngüseldir ve her model kendi imlecini (ClipCursor) tutar: zaman
+ileri aktığı sürece imleç bir sonraki anahtara kayar, böylece bir karede
+her iz için arama yerine sabit süre harcanır.
+
+Metin biçimi (bkz. clips/jumping-jacks.clip):
+
+    length ADIM
+    track PARÇA EKSEN TOLERANS
+    ADIM AÇI
+    ...
+
+PARÇA: leftArm, leftForearm, leftFoot, rightArm, rightForearm, rightFoot
+EKSEN: x, y veya z; ADIM: 1/SIMULATION_RATE saniye, 0 ile CLIP_MAX_VALUE
+arasında tamsayı (anahtarlar 16 bitlik adımla saklanır); AÇI ve
+TOLERANS: derece
+*/
+
+#define CLIP_MAX_VALUE 65535
+
+typedef struct clipKey
+{
+    uint16_t tick;  // klibin başından itibaren simülasyon adımı
+    uint16_t value; // nicemlenmiş açı
+} ClipKey;
+
+typedef struct clipTrack
+{
+    int part, direction;    // setAngle'a verilecek parça ve eksen
+    int firstKey, keyCount; // anahtarların ClipKey dizisindeki yeri
+    float minimum, step;    // açı = minimum + value * step (derece)
+    float maxError;         // kaynak açılara göre en büyük hata (derece)
+} ClipTrack;
+
+typedef struct clipCursor
+{
+    std::vector<int> keys; // her iz için son geçilen anahtar
+    double tick;           // son örneklenen an (adım)
+} ClipCursor;
+
+class AnimationClip
+{
+private:
+    std::vector<ClipTrack> tracks;
+    std::vector<ClipKey> keys;
+    int length;
+
+public:
+    AnimationClip(void)
+    {
+        length = 0;
+    }
+    void clear(void)
+    {
+        tracks.clear();
+        keys.clear();
+        length = 0;
+    }
+    bool isEmpty(void) const
+    {
+        return tracks.empty() || length <= 0;
+    }
+    int getLength(void) const
+    {
+        // Döngünün uzunluğu (adım)
+        return length;
+    }
+    void setLength(int ticks)
+    {
+        length = std::min(std::max(ticks, 0), CLIP_MAX_VALUE);
+    }
+    int trackCount(void) const
+    {
+        return tracks.size();
+    }
+    const ClipTrack &getTrack(int track) const
+    {
+        return tracks[track];
+    }
+    size_t memoryUsage(void) const
+    {
+        return tracks.size() * sizeof(ClipTrack) + keys.size() * sizeof(ClipKey);
+    }
+
+    static bool isTick(double tick)
+    {
+        // Anahtar adımları 16 bitlik tamsayı olarak saklanır; kesirli veya
+        // sığmayan adımlar yuvarlanmak yerine reddedilir.
+        return tick >= 0 && tick <= CLIP_MAX_VALUE && tick == std::floor(tick);
+    }
+    bool addTrack(int part, int direction, const std::vector<double> &ticks, const std::vector<double> &angles, double tolerance)
+    {
+        // Artan adımlarla verilen açıları nicemleyip ekler. Doğrusal ara
+        // değerlemeyle tolerans içinde kalan ara anahtarlar atılır.
+        int count = ticks.size();
+        if (count == 0 || (int)angles.size() != count)
+            return false;
+        for (int i = 0; i < count; i++)
+            if (!isTick(ticks[i]) || (i > 0 && ticks[i] <= ticks[i - 1]))
+                return false;
+
+        ClipTrack track;
+        track.part = part;
+        track.direction = direction;
+        track.firstKey = keys.size();
+        double minimum = *std::min_element(angles.begin(), angles.end());
+        double maximum = *std::max_element(angles.begin(), angles.end());
+        track.minimum = minimum;
+        track.step = (maximum - minimum) / CLIP_MAX_VALUE;
+
+        // Her tutulan anahtardan, aradaki tüm açıları tolerans içinde
+        // geçen en uzak anahtara atlanır.
+        std::vector<int> kept(1, 0);
+        while (kept.back() < count - 1)
+        {
+            int from = kept.back(), to = from + 1;
+            for (int next = to + 1; next < count; next++)
+            {
+                bool fits = true;
+                for (int i = from + 1; i < next && fits; i++)
+                {
+                    double t = (ticks[i] - ticks[from]) / (ticks[next] - ticks[from]);
+                    fits = std::fabs(angles[from] + (angles[next] - angles[from]) * t - angles[i]) <= tolerance;
+                }
+                if (!fits)
+                    break;
+                to = next;
+            }
+            kept.push_back(to);
+        }
+
+        for (size_t i = 0; i < kept.size(); i++)
+        {
+            ClipKey key;
+            key.tick = (uint16_t)ticks[kept[i]];
+            key.value = track.step > 0 ? (uint16_t)std::floor((angles[kept[i]] - minimum) / track.step + 0.5) : 0;
+            keys.push_back(key);
+        }
+        track.keyCount = kept.size();
+        track.maxError = 0;
+        tracks.push_back(track);
+        length = std::max(length, (int)keys.back().tick);
+
+        // Gerçek hata, kaynak açıların nicemlenmiş klipten örneklenmesiyle ölçülür
+        ClipCursor cursor;
+        resetCursor(cursor);
+        for (int i = 0; i < count; i++)
+        {
+            cursor.tick = ticks[i];
+            double error = std::fabs(sample(cursor, tracks.size() - 1) - angles[i]);
+            tracks.back().maxError = std::max((double)tracks.back().maxError, error);
+        }
+        return true;
+    }
+
+    bool load(const std::string &path)
+    {
+        // Metin biçimindeki klibi okur; hata olursa klip boş kalır.
+        clear();
+        std::ifstream source(path.c_str());
+        if (!source)
+        {
+            std::cerr << "klip açılamadı: " << path << std::endl;
+            return false;
+        }
+
+        static const struct
+        {
+            const char *name;
+            int part;
+        } partNames[] = {
+            {"leftArm", LEFT_ARM},
+            {"leftForearm", LEFT_FOREARM},
+            {"leftFoot", LEFT_FOOT},
+            {"rightArm", RIGHT_ARM},
+            {"rightForearm", RIGHT_FOREARM},
+            {"rightFoot", RIGHT_FOOT}};
+
+        int declaredLength = 0;
+        int part = -1, direction = -1;
+        double tolerance = 0;
+        std::vector<double> ticks, angles;
+        std::string line;
+        bool valid = true;
+        for (int lineNumber = 1; valid; lineNumber++)
+        {
+            // # sonrası açıklamadır, boş satırlar atlanır
+            bool more = (bool)std::getline(source, line);
+            std::istringstream fields(more ? line.substr(0, line.find('#')) : std::string());
+            std::string word;
+            if (more && !(fields >> word))
+                continue;
+
+            // Yeni bir iz başladığında (veya dosya bittiğinde) önceki iz eklenir
+            if ((!more || word == "track") && part >= 0)
+            {
+                valid = addTrack(part, direction, ticks, angles, tolerance);
+                ticks.clear();
+                angles.clear();
+                part = -1;
+            }
+
+            if (!more)
+                break;
+            else if (word == "length")
+                valid = (bool)(fields >> declaredLength) && declaredLength > 0 && declaredLength <= CLIP_MAX_VALUE;
+            else if (word == "track")
+            {
+                std::string name, axis;
+                valid = (bool)(fields >> name >> axis >> tolerance) && tolerance >= 0;
+                for (size_t i = 0; i < sizeof(partNames) / sizeof(partNames[0]); i++)
+                    if (name == partNames[i].name)
+                        part = partNames[i].part;
+                direction = axis == "x" ? X : axis == "y" ? Y : axis == "z" ? Z : -1;
+                valid = valid && part >= 0 && direction >= 0;
+            }
+            else
+            {
+                double tick, angle;
+                valid = part >= 0 && (bool)(std::istringstream(word) >> tick) && (bool)(fields >> angle) && isTick(tick);
+                ticks.push_back(tick);
+                angles.push_back(angle);
+            }
+
+            if (!valid)
+                std::cerr << path << ":" << lineNumber << ": geçersiz klip satırı" << std::endl;
+        }
+
+        if (valid && declaredLength > 0)
+            setLength(declaredLength);
+        if (!valid || isEmpty())
+        {
+            if (valid)
+                std::cerr << path << ": klipte iz yok" << std::endl;
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+    void resetCursor(ClipCursor &cursor) const
+    {
+        cursor.keys.resize(tracks.size());
+        for (size_t i = 0; i < tracks.size(); i++)
+            cursor.keys[i] = tracks[i].firstKey;
+        cursor.tick = 0;
+    }
+    void seek(ClipCursor &cursor, double tick) const
+    {
+        // İmleç ileri giderken anahtarlar sample içinde sırayla geçilir;
+        // döngü başa sardığında (veya zaman geri gittiğinde) baştan başlar.
+        if (cursor.keys.size() != tracks.size() || tick < cursor.tick)
+            resetCursor(cursor);
+        cursor.tick = tick;
+    }
+    double sample(ClipCursor &cursor, int track) const
+    {
+        // İzin imleç anındaki açısı (derece). İlk anahtardan önce ve son
+        // anahtardan sonra uçtaki değer korunur.
+        const ClipTrack &clipTrack = tracks[track];
+        int &key = cursor.keys[track];
+        int last = clipTrack.firstKey + clipTrack.keyCount - 1;
+        while (key < last && keys[key + 1].tick <= cursor.tick)
+            key++;
+
+        const ClipKey &a = keys[key];
+        double value = a.value;
+        if (key < last && cursor.tick > a.tick)
+        {
+            const ClipKey &b = keys[key + 1];
+            value += ((double)b.value - a.value) * (cursor.tick - a.tick) / (b.tick - a.tick);
+        }
+        return clipTrack.minimum + value * clipTrack.step;
+    }
+};
+
+/////////////////////////////////////////////////////////////////// POZ KARIŞTIRMA
+
+/*
+Animasyonlar eklemlere doğrudan yazmak yerine kendi katmanlarındaki
+poza yazar. Katmanlar sırayla, dinlenme pozunun (klavyeyle ayarlanan
+duruş) üstüne ağırlıklarıyla karıştırılır:
+
+    override: kanal += (katman - kanal) * ağırlık * maske
+    additive: kanal += katman * ağırlık * maske
+
+Maske kanal başına ağırlıktır (0: katman o kanala dokunmaz), böylece
+tüm vücut veya tek eklem katmanları aynı döngüyle karışır. Bir katman
+açılıp kapatıldığında ağırlığı BLEND_FADE_TIME içinde doğrusal olarak
+değişir; geçiş simülasyon zamanına bağlı olduğu için animasyonlar
+gibi istenen ana atlanabilir.
+
+Poz kanalları setAngle'ın sürdüğü altı eklemin X, Y, Z açıları ile
+modelin konumu ve Y eksenindeki yönüdür. Dizi boyu, döngüler
+vektörleşsin diye 8'in katına tamamlanır. Karıştırma bellek ayırmaz.
+*/
+
+#define POSE_JOINTS 6 // LEFT_ARM ... RIGHT_FOOT
+#define POSE_ROOT_X 18
+#define POSE_ROOT_Y 19
+#define POSE_ROOT_Z 20
+#define POSE_HEADING 21
+#define POSE_CHANNELS 24
+
+#define LAYER_OVERRIDE 0
+#define LAYER_ADDITIVE 1
+
+// Human'ın animasyon katmanları, karıştırma sırasıyla
+#define LAYER_ROAMING 0
+#define LAYER_WAVING 1
+#define LAYER_WALKING 2
+#define LAYER_CLIP 3
+#define LAYER_COUNT 4
+
+#define BLEND_FADE_TIME 0.25
+
+typedef struct pose
+{
+    double channels[POSE_CHANNELS];
+} Pose;
+
+typedef struct poseLayer
+{
+    int mode; // LAYER_OVERRIDE veya LAYER_ADDITIVE
+    double mask[POSE_CHANNELS];
+    Pose pose;
+
+    // Ağırlık fadeStartTime anında fadeFrom'dan başlayıp
+    // fadeDuration saniye sonra fadeTo olur.
+    double fadeStartTime, fadeFrom, fadeTo, fadeDuration;
+} PoseLayer;
+
+inline int poseChannel(int part, int direction)
+{
+    // setAngle'daki parça ve eksenin poz kanalı
+    return (part - LEFT_ARM) * 3 + direction;
+}
+
+double layerWeight(const PoseLayer &layer, double time)
+{
+    if (layer.fadeDuration <= 0 || time >= layer.fadeStartTime + layer.fadeDuration)
+        return layer.fadeTo;
+    if (time <= layer.fadeStartTime)
+        return layer.fadeFrom;
+    return layer.fadeFrom + (layer.fadeTo - layer.fadeFrom) * (time - layer.fadeStartTime) / layer.fadeDuration;
+}
+
+void fadeLayer(PoseLayer &layer, double time, double weight, double duration = BLEND_FADE_TIME)
+{
+    // Ağırlık o anki değerinden hedefe geçer; yarım kalan bir
+    // geçişin tersi de kalan yol kadar sürer.
+    layer.fadeFrom = layerWeight(layer, time);
+    layer.fadeTo = weight;
+    layer.fadeStartTime = time;
+    layer.fadeDuration = duration * std::fabs(weight - layer.fadeFrom);
+}
+
+void blendPose(Pose &result, const Pose &rest, const PoseLayer *layers, int count, double time)
+{
+    // Katmanlar sırayla dinlenme pozunun üstüne karıştırılır
+    result = rest;
+    for (int i = 0; i < count; i++)
+    {
+        const PoseLayer &layer = layers[i];
+        double weight = layerWeight(layer, time);
+        if (weight <= 0)
+            continue;
+
+        double *out = result.channels;
+        const double *in = layer.pose.channels, *mask = layer.mask;
+        if (layer.mode == LAYER_ADDITIVE)
+            for (int c = 0; c < POSE_CHANNELS; c++)
+                out[c] += in[c] * weight * mask[c];
+        else
+            for (int c = 0; c < POSE_CHANNELS; c++)
+                out[c] += (in[c] - out[c]) * weight * mask[c];
+    }
+}
+
+/////////////////////////////////////////////////////////////////// ANİMASYON DÖNGÜLERİ
+
+/*
+Yerleşik animasyonlar (yürüme, el sallama, dolaşma) tamamlanma
+yüzdesinin periyodik fonksiyonlarıdır. Bu fonksiyonlar başlangıçta bir
+kez, döngü başına CYCLE_SAMPLES örnekle tablolara hesaplanır (bake);
+her model ve her karede sin/cos yerine tablodaki iki komşu örnek
+arasında doğrusal ara değer alınır. Tablolar tüm modellerde ortaktır,
+modellerin farklı fazlarda olması yalnızca okunan satırı değiştirir.
+
+Tablonun son satırı ilk satırın tekrarıdır; böylece döngünün sonu ile
+başı arasında da ara değer alınabilir. --cycle-samples=0 tabloları
+kapatır ve fonksiyonlar her karede hesaplanır.
+*/
+
+#define CYCLE_SAMPLES 256
+
+// Bir döngünün tamamlanma yüzdesindeki (0-1) pozunu yazan fonksiyon
+typedef void (*CycleFunction)(double percent, Pose &pose);
+
+class AnimationCycle
+{
+private:
+    // Tablodaki poz kanalları ve [örnek][kanal] sırasıyla değerleri
+    std::vector<int> channels;
+    std::vector<float> values;
+    int samples;
+
+public:
+    AnimationCycle(void)
+    {
+        samples = 0;
+    }
+    void bake(CycleFunction function, const int *channels, int channelCount, int samples)
+    {
+        // samples <= 0 ise tablo boş kalır
+        this->channels.assign(channels, channels + channelCount);
+        this->samples = std::max(samples, 0);
+        values.clear();
+        if (this->samples == 0)
+            return;
+
+        values.resize((this->samples + 1) * channelCount);
+        Pose pose;
+        memset(&pose, 0, sizeof(pose));
+        for (int sample = 0; sample < this->samples; sample++)
+        {
+            function((double)sample / this->samples, pose);
+            for (int k = 0; k < channelCount; k++)
+                values[sample * channelCount + k] = pose.channels[channels[k]];
+        }
+        std::copy(values.begin(), values.begin() + channelCount, values.begin() + this->samples * channelCount);
+    }
+    bool isBaked(void) const
+    {
+        return samples > 0;
+    }
+    void sample(double percent, Pose &pose) const
+    {
+        // Yüzdenin iki yanındaki örnekler arasında doğrusal ara değer
+        double position = (percent - std::floor(percent)) * samples;
+        int index = std::min((int)position, samples - 1);
+        double t = position - index;
+        int count = channels.size();
+        const float *a = &values[index * count], *b = a + count;
+        for (int k = 0; k < count; k++)
+            pose.channels[channels[k]] = a[k] + (b[k] - a[k]) * t;
+    }
+    size_t memoryUsage(void) const
+    {
+        return values.size() * sizeof(float) + channels.size() * sizeof(int);
+    }
+};
+
+// Yerleşik animasyonların tüm modellerin paylaştığı tabloları
+// (bkz. Human::bakeCycles)
+AnimationCycle walkCycleTable, waveCycleTable, roamCycleTable;
+
+/////////////////////////////////////////////////////////////////// İNSAN MODELİ
+
+// Dolaşma animasyonunda modelin tur attığı çemberin yarıçapı
+#define ROAM_RADIUS 3
+
+class Human
+{
+private:
+    // Object tipinde tüm vücut parçaları ve
+    // eklemler için nesneler oluşturuluyor.
+
+    // Human::init içinde bu nesneler birbiriyle
+    // parent-child ilişkisiyle bağlanacak.
+
+    Object
+        body,
+        head,
+        neck,
+        leftEyeOutside,
+        leftEyeInside,
+        leftArm,
+        leftForearm,
+        leftFoot,
+        leftShoulder,
+        leftElbow,
+        leftHip,
+        rightEyeOutside,
+        rightEyeInside,
+        rightArm,
+        rightForearm,
+        rightFoot,
+        rightShoulder,
+        rightElbow,
+        rightHip;
+
+    // Tüm iskeletin durma noktası ve açısı
+
+    Coordinates mainPosition;
+    Angles mainAngle;
+
+    // Animasyonlar için açık-kapalı durumunu gösteren bool'lar
+    // (kapatılan animasyon katmanı sönene kadar çalışmaya devam eder)
+    // Animasyonun döngüsünü tamamlama yüzdesi double'lar
+    // Animasyonun toplam kaç simülasyon adımı süreceğini gösteren double'lar (animasyonun hızını belirliyor)
+    // Animasyonun başlatıldığı an (saniye) ve o andaki tamamlanma yüzdesi
+
+    bool walking;
+    double walkingCompletionPercent;
+    double walkingTotalAnimationIteration;
+    double walkingStartTime, walkingStartPercent;
+
+    bool waving;
+    double wavingCompletionPercent;
+    double wavingTotalAnimationIteration;
+    double wavingStartTime, wavingStartPercent;
+
+    bool roaming;
+    double roamingCompletionPercent;
+    double roamingTotalAnimationIteration;
+    double roamingStartTime, roamingStartPercent;
+
+    // Dolaşılan çemberin merkezi ve roamCycle'ın çemberine göre ölçeği;
+    // roamAround kapalıysa (tek model) çember sahnenin merkezindedir
+    bool roamAround;
+    Coordinates roamCenter;
+    double roamScale;
+
+    // Oynatılan anahtar kare klibi (yoksa NULL), döngünün tamamlanma
+    // yüzdesi ve bu modelin klipteki imleci
+    bool clipPlaying;
+    const AnimationClip *clip;
+    double clipCompletionPercent;
+    double clipStartTime, clipStartPercent;
+    ClipCursor clipCursor;
+
+    // Animasyon katmanları (karıştırma sırasıyla), klavyeyle ayarlanan
+    // dinlenme pozu ve karıştırılmış poz (bkz. blendPose)
+    PoseLayer layers[LAYER_COUNT];
+    Pose restPose, pose;
+
+    // Pozun en son hesaplandığı simülasyon anı (saniye)
+    double animationTime;
+
+    // Vücut parçalarının düzleştirilmiş hali (init sonunda kurulur)
+    Skeleton skeleton;
+
+    // Parça sabitlerinin (LEFT_ARM, RIGHT_FOOT, ...) eklem numaraları
+    // (parça iskelette yoksa veya kökse -1)
+    int partJoints[RIGHT_HIP + 1];
+
+public:
+    // Human Constructor'ı member variable
+    // olan Object nesnelerinin constructor'larını
+    // çağırır ve bu esnada bu cisimlerin silindir-küre
+    // olma durumunu da işaretler.
+
+    Human(void)
+        : body(CYLINDER, ROOT_OBJECT)
+
+          ,
+          head(SPHERE), leftEyeOutside(SPHERE), leftEyeInside(SPHERE), rightEyeOutside(SPHERE), rightEyeInside(SPHERE), neck(CYLINDER)
+
+          ,
+          leftArm(CYLINDER), leftForearm(CYLINDER), leftFoot(CYLINDER)
+
+          ,
+          rightArm(CYLINDER), rightForearm(CYLINDER), rightFoot(CYLINDER)
+
+          ,
+          leftShoulder(SPHERE), leftElbow(SPHERE), leftHip(SPHERE)
+
+          ,
+          rightShoulder(SPHERE), rightElbow(SPHERE), rightHip(SPHERE)
+    {
+        walkingCompletionPercent = 0;
+        wavingCompletionPercent = 0;
+        roamingCompletionPercent = 0;
+        walking = false;
+        waving = false;
+        roaming = false;
+        roamAround = false;
+        roamCenter = {0, 0, 0};
+        roamScale = 1;
+        clipPlaying = false;
+        clip = NULL;
+        clipCompletionPercent = 0;
+        animationTime = 0;
+
+        mainPosition = {0, -0.07, 0};
+        mainAngle = {0, 0, 0};
+
+        // Katmanlar kapalı başlar; her biri yalnızca kendi
+        // animasyonunun sürdüğü kanalları etkiler.
+        memset(layers, 0, sizeof(layers));
+        for (int layer = 0; layer < LAYER_COUNT; layer++)
+            layers[layer].mode = LAYER_OVERRIDE;
+        layers[LAYER_ROAMING].mask[POSE_ROOT_X] = 1;
+        layers[LAYER_ROAMING].mask[POSE_ROOT_Z] = 1;
+        layers[LAYER_ROAMING].mask[POSE_HEADING] = 1;
+        layers[LAYER_WAVING].mask[poseChannel(LEFT_ARM, Z)] = 1;
+        layers[LAYER_WAVING].mask[poseChannel(LEFT_FOREARM, Z)] = 1;
+
+        // Yürüme dinlenme pozuna eklenir: bacaklar duruşun etrafında
+        // sallanır, model bulunduğu yükseklikten inip kalkar.
+        layers[LAYER_WALKING].mode = LAYER_ADDITIVE;
+        layers[LAYER_WALKING].mask[poseChannel(LEFT_FOOT, X)] = 1;
+        layers[LAYER_WALKING].mask[poseChannel(RIGHT_FOOT, X)] = 1;
+        layers[LAYER_WALKING].mask[POSE_ROOT_Y] = 1;
+
+        memset(&restPose, 0, sizeof(restPose));
+        pose = restPose;
+        std::fill(partJoints, partJoints + RIGHT_HIP + 1, -1);
+        return;
+    }
+    void init(void)
+    {
+        // Program içindeki varsayılan iskeletle kurulum
+        static const Rig defaultRig;
+        init(defaultRig);
+    }
+    void init(const Rig &rig)
+    {
+        // Bu metod OpenGL ile ilk defa iletişim kurulduğunda
+        // çağrılır ve her Human nesnesi için bir kere çalışır.
+
+        // Görevi her vücut parçası için ölçü, renk, iç döndürme
+        // tanımlamalarını iskelet dosyasından yapar ve parçaları
+        // parent-child ilişkisine göre linkler. (Düğümler dosyada
+        // parent'larından sonra geldiği için tek geçiş yeterli; Rig
+        // her ismin tanınan, tekil bir parça olduğunu doğrulamıştır.)
+
+        const RigNode *nodes = rig.getNodes();
+        std::vector<Object *> parts(rig.size(), (Object *)NULL);
+        for (int i = 0; i < rig.size(); i++)
+        {
+            const RigNode &node = nodes[i];
+            parts[i] = findPart(node.name);
+
+            // PARÇANIN OLUŞTURULMASI, ÖLÇÜLENDİRİLMESİ
+            parts[i]->setShape(node.shape);
+            parts[i]->set(
+                node.dimensions[0], node.dimensions[1], node.dimensions[2],
+                node.color[0], node.color[1], node.color[2],
+                node.rotate[0], node.rotate[1], node.rotate[2]);
+
+            // PARENT'A BAĞLANMASI (İSKELET)
+            if (node.parent >= 0)
+                parts[node.parent]->link(
+                    *parts[i],
+                    node.jointAngles[0], node.jointAngles[1], node.jointAngles[2],
+                    node.parentOffset[0], node.parentOffset[1], node.parentOffset[2],
+                    node.childOffset[0], node.childOffset[1], node.childOffset[2]);
+        }
+
+        // İleri kinematik için ağacın düzleştirilmesi
+        skeleton.build(body);
+
+        // Parça sabitleri, parçayı parent'ına bağlayan ekleme karşılık gelir
+        Object *partObjects[RIGHT_HIP + 1] = {
+            &body, &head, &neck, &leftArm, &leftForearm, &leftFoot, &rightArm, &rightForearm, &rightFoot,
+            &leftShoulder, &leftElbow, &leftHip, &rightShoulder, &rightElbow, &rightHip};
+        for (int part = 0; part <= RIGHT_HIP; part++)
+        {
+            int joint = skeleton.findNode(partObjects[part]);
+            partJoints[part] = joint > 0 ? joint : -1;
+        }
+
+        // Animasyonların sürdüğü eklemler işaretlenir; sabit alt ağaçlar
+        // yalnızca setRigidMerging ile istenirse birleştirilir
+        // (bkz. Skeleton::mergeRigid)
+        for (int joint = 0; joint < POSE_JOINTS; joint++)
+            if (partJoints[LEFT_ARM + joint] > 0)
+                skeleton.drive(partJoints[LEFT_ARM + joint]);
+
+        // Dinlenme pozu iskeletin başlangıç açıları ve konumudur
+        for (int joint = 0; joint < POSE_JOINTS; joint++)
+            for (int direction = X; direction <= Z; direction++)
+            {
+                double *angles = partAngles(LEFT_ARM + joint, direction);
+                restPose.channels[joint * 3 + direction] = angles ? *angles : 0;
+            }
+        restPose.channels[POSE_ROOT_X] = mainPosition.x;
+        restPose.channels[POSE_ROOT_Y] = mainPosition.y;
+        restPose.channels[POSE_ROOT_Z] = mainPosition.z;
+        restPose.channels[POSE_HEADING] = mainAngle.y;
+        pose = restPose;
+    }
+    Object *findPart(const char *name)
+    {
+        // İskelet dosyasındaki isimlerin (rigPartNames, aynı sırayla)
+        // Human'daki karşılıkları
+        static Object Human::*const parts[] = {
+            &Human::body, &Human::head, &Human::neck,
+            &Human::leftEyeOutside, &Human::leftEyeInside, &Human::leftArm, &Human::leftForearm, &Human::leftFoot,
+            &Human::leftShoulder, &Human::leftElbow, &Human::leftHip,
+            &Human::rightEyeOutside, &Human::rightEyeInside, &Human::rightArm, &Human::rightForearm, &Human::rightFoot,
+            &Human::rightShoulder, &Human::rightElbow, &Human::rightHip};
+        static_assert(sizeof(parts) / sizeof(parts[0]) == RIG_PARTS, "rigPartNames ile aynı sayıda parça olmalı");
+
+        int part = rigPartIndex(name);
+        if (part >= 0)
+            return &(this->*parts[part]);
+        return NULL;
+    }
+    void animate(double time)
+    {
+        // Açık olan animasyonların verilen simülasyon anındaki (saniye)
+        // pozunu hesaplar. Sonuç önceki çağrılara bağlı olmadığı için
+        // zaman ileri veya geri istenen ana atlayabilir.
+        animationTime = time;
+        profiler.begin("roamingAnimation");
+        roamingAnimation();
+        profiler.end();
+        profiler.begin("waveAnimation");
+        waveAnimation();
+        profiler.end();
+        profiler.begin("walkAnimation");
+        walkAnimation();
+        profiler.end();
+        profiler.begin("clipAnimation");
+        clipAnimation();
+        profiler.end();
+
+        // Katmanlar tek poza karıştırılıp eklemlere uygulanır
+        profiler.begin("blendPose");
+        blendPose(pose, restPose, layers, LAYER_COUNT, animationTime);
+        applyPose(pose);
+        profiler.end();
+    }
+    void applyPose(const Pose &pose)
+    {
+        // Poz kanalları eklem dizisine yazılır
+        Angles *joints = skeleton.getPose();
+        for (int joint = 0; joint < POSE_JOINTS; joint++)
+        {
+            int node = partJoints[LEFT_ARM + joint];
+            if (node < 0)
+                continue;
+            joints[node].x = pose.channels[joint * 3 + X];
+            joints[node].y = pose.channels[joint * 3 + Y];
+            joints[node].z = pose.channels[joint * 3 + Z];
+        }
+        mainPosition.x = pose.channels[POSE_ROOT_X];
+        mainPosition.y = pose.channels[POSE_ROOT_Y];
+        mainPosition.z = pose.channels[POSE_ROOT_Z];
+        mainAngle.y = pose.channels[POSE_HEADING];
+    }
+    bool isLayerActive(int layer)
+    {
+        // Açık olan veya sönmekte olan katman hesaplanır
+        return layers[layer].fadeTo > 0 || layerWeight(layers[layer], animationTime) > 0;
+    }
+    Matrix4 getRootMatrix(void)
+    {
+        // update metodundaki konumlandırmanın CPU'daki karşılığı
+        return translationMatrix(mainPosition.x, mainPosition.y, mainPosition.z) *
+               rotationMatrix(mainAngle.x, X) *
+               rotationMatrix(mainAngle.y, Y) *
+               rotationMatrix(mainAngle.z, Z) *
+               translationMatrix(0.0, 1.7, 0.0);
+    }
+    void evaluate(void)
+    {
+        // Tüm cisimlerin dünya matrisleri hesaplanır.
+        skeleton.evaluate(getRootMatrix());
+    }
+    void selectLods(Coordinates eye, double pixelScale)
+    {
+        // Her cismin ayrıntı seviyesi, sınır küresinin ekrandaki
+        // yarıçapına göre seçilir. (evaluate'ten sonra çağrılmalı)
+        // pixelScale: 1 birim uzaklıktaki 1 birimlik cismin piksel boyu
+        for (int i = 0, length = skeleton.size(); i < length; i++)
+        {
+            Object *node = skeleton.getNode(i);
+            if (node->isMerged())
+                continue;
+            Coordinates position = skeleton.getPosition(i);
+            double dx = position.x - eye.x, dy = position.y - eye.y, dz = position.z - eye.z;
+            double distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz), 1e-6);
+            node->setLod(selectLodLevel(node->getLodRadius() * pixelScale / distance, node->getLod()));
+        }
+    }
+    void cull(const Frustum &frustum)
+    {
+        // Görüş alanı dışındaki cisimleri ve alt ağaçları işaretler
+        // (evaluate'ten sonra çağrılmalı)
+        skeleton.cull(frustum);
+    }
+    void collect(std::vector<DrawItem> &items)
+    {
+        // Tampon tabanlı çizicinin görünen her cisim için kullanacağı
+        // bilgiler (evaluate ve cull'dan sonra çağrılmalı)
+        for (int i = 0, length = skeleton.size(); i < length; i++)
+        {
+            if (!skeleton.getNode(i)->isVisible())
+                continue;
+
+            DrawItem item;
+            item.mesh = skeleton.getNode(i)->getMesh();
+            item.color = skeleton.getNode(i)->getColor();
+            item.model = skeleton.getMeshMatrix(i);
+            items.push_back(item);
+        }
+    }
+    Skeleton &getSkeleton(void)
+    {
+        return skeleton;
+    }
+    void setRigidMerging(bool enabled)
+    {
+        // Sabit alt ağaçlar tek mesh'le mi, parça parça mı çizilir
+        skeleton.setMerging(enabled);
+    }
+    bool isAnimating(void)
+    {
+        // Açık veya sönmekte olan bir animasyon varsa poz her karede değişir
+        for (int layer = 0; layer < LAYER_COUNT; layer++)
+            if (isLayerActive(layer))
+                return true;
+        return false;
+    }
+    void update(void)
+    {
+        // Sahneye çizilecek diğer nesneler için vücudun çizimi sırasında
+        // kullanılacak rotate-scale-translate'den sonra koordinatların
+        // değişme için push-pop kullanılıyor.
+
+        // Animasyonlar konum ve eklem açılarını çizimden önce animate
+        // ile belirler.
+
+        glPushMatrix();
+
+        // İskeletin E-S-D-F ile dolaşması için
+        glTranslated(mainPosition.x, mainPosition.y, mainPosition.z);
+        glRotated(mainAngle.x, 1, 0, 0);
+        glRotated(mainAngle.y, 0, 1, 0);
+        glRotated(mainAngle.z, 0, 0, 1);
+
+        glPushMatrix();
+
+        // Zemine batmaması için model yükseltiliyor.
+        glTranslated(0.0, 1.7, 0.0);
+
+        // Gövde nesnesi için çizim fonksiyonu çağrılıyor. Bu metod, kendisine
+        // bağlı cisimler için içinden çağrılacak ve tüm vücut çizilmiş olacak.
+        profiler.begin("body.update", true);
+        body.update();
+        profiler.end();
+
+        glPopMatrix();
+
+        glPopMatrix();
+    }
+
+    void setHeading(double angle)
+    {
+        // Modelin Y ekseni etrafındaki yönünü seçer
+        mainAngle.y = restPose.channels[POSE_HEADING] = angle;
+    }
+    void setPhase(double phase)
+    {
+        // Animasyonların döngüye hangi noktadan başlayacağını seçer.
+        // (Kalabalıktaki modellerin aynı anda adım atmaması için)
+        walkingCompletionPercent = walkingStartPercent = phase;
+        wavingCompletionPercent = wavingStartPercent = phase;
+        roamingCompletionPercent = roamingStartPercent = phase;
+        clipCompletionPercent = clipStartPercent = phase;
+        walkingStartTime = wavingStartTime = roamingStartTime = clipStartTime = animationTime;
+    }
+    void setCyclePhases(double walking, double waving)
+    {
+        // Yürüme ve el sallamanın bu andaki tamamlanma yüzdeleri
+        // (bkz. ImpostorAtlas::bake)
+        walkingCompletionPercent = walkingStartPercent = walking;
+        wavingCompletionPercent = wavingStartPercent = waving;
+        walkingStartTime = wavingStartTime = animationTime;
+    }
+    void getCyclePhases(double &walking, double &waving)
+    {
+        // Son animate çağrısındaki tamamlanma yüzdeleri
+        walking = walkingCompletionPercent;
+        waving = wavingCompletionPercent;
+    }
+    void setCycleLayers(bool walking, bool waving)
+    {
+        // Yürüme ve el sallama katmanlarını geçişsiz açar veya kapatır
+        // (bkz. ImpostorAtlas::bake)
+        fadeLayer(layers[LAYER_WALKING], animationTime, walking ? 1 : 0, 0);
+        fadeLayer(layers[LAYER_WAVING], animationTime, waving ? 1 : 0, 0);
+    }
+    void getCycleWeights(double &walking, double &waving)
+    {
+        // Yürüme ve el sallama katmanlarının son animate anındaki ağırlığı
+        walking = layerWeight(layers[LAYER_WALKING], animationTime);
+        waving = layerWeight(layers[LAYER_WAVING], animationTime);
+    }
+    double completionPercentAt(double startTime, double startPercent, double totalAnimationIteration)
+    {
+        // Animasyonun animationTime anındaki tamamlanma yüzdesi:
+        // başlangıçtan beri geçen adım sayısının döngü uzunluğuna oranı
+        double cycles = startPercent + (animationTime - startTime) * SIMULATION_RATE / totalAnimationIteration;
+        return cycles - std::floor(cycles);
+    }
+    static void bakeCycles(int samples)
+    {
+        // Yerleşik animasyonların döngü tablolarını hesaplar (bkz.
+        // AnimationCycle). İş parçacıkları başlamadan çağrılmalı.
+        const int walkChannels[] = {poseChannel(LEFT_FOOT, X), poseChannel(RIGHT_FOOT, X), POSE_ROOT_Y};
+        const int waveChannels[] = {poseChannel(LEFT_ARM, Z), poseChannel(LEFT_FOREARM, Z)};
+        const int roamChannels[] = {POSE_ROOT_X, POSE_ROOT_Z};
+        walkCycleTable.bake(walkCycle, walkChannels, 3, samples);
+        waveCycleTable.bake(waveCycle, waveChannels, 2, samples);
+        roamCycleTable.bake(roamCycle, roamChannels, 2, samples);
+    }
+
+    void setMainCoordinates(double x, double y, double z)
+    {
+        // Modelin koordinatlarını seçer
+        mainPosition.x = restPose.channels[POSE_ROOT_X] = x;
+        mainPosition.y = restPose.channels[POSE_ROOT_Y] = y;
+        mainPosition.z = restPose.channels[POSE_ROOT_Z] = z;
+    }
+    void raiseMainCoordinates(double x, double y, double z)
+    {
+        // Modelin koordinatlarını düzenler
+        mainPosition.x = restPose.channels[POSE_ROOT_X] += x;
+        mainPosition.y = restPose.channels[POSE_ROOT_Y] += y;
+        mainPosition.z = restPose.channels[POSE_ROOT_Z] += z;
+    }
+    Coordinates getMainCoordinates(void)
+    {
+        return mainPosition;
+    }
+    Angles getMainAngle(void)
+    {
+        return mainAngle;
+    }
+    void setRootPose(Coordinates position, Angles angle)
+    {
+        // Başka bir modelin (ör. simülasyondaki kopyanın) kök konumunu
+        // ve açısını alır; dinlenme pozu değişmez.
+        mainPosition = position;
+        mainAngle = angle;
+    }
+
+    void raiseAngle(int partNumber, int direction, double angle)
+    {
+        // Bu metod spesifik bir vücut parçası için ilgili ekleminin
+        // dönüş değerlerini artırıp azaltıyor. Değişiklik dinlenme
+        // pozuna da yazılır, animasyonlar bu duruşun üstüne karışır.
+        if (partNumber >= LEFT_ARM && partNumber <= RIGHT_FOOT && direction >= X && direction <= Z)
+            restPose.channels[poseChannel(partNumber, direction)] += angle;
+        double *angles = partAngles(partNumber, direction);
+        if (angles)
+        {
+            *angles += angle;
+            skeleton.drive(partJoints[partNumber]);
+        }
+    }
+    void setAngle(int partNumber, int direction, double angle)
+    {
+        // Bu metod spesifik bir vücut parçası için ilgili ekleminin
+        // dönüş değerlerini değiştiriyor.
+        double *angles = partAngles(partNumber, direction);
+        if (angles)
+        {
+            *angles = angle;
+            skeleton.drive(partJoints[partNumber]);
+        }
+    }
+    double *partAngles(int partNumber, int direction)
+    {
+        // Parçayı parent'ına bağlayan eklemin verilen eksendeki açısı
+        // (parça iskelette yoksa NULL)
+        if (partNumber < 0 || partNumber > RIGHT_HIP || direction < X || direction > Z || partJoints[partNumber] < 0)
+            return NULL;
+        Angles &joint = skeleton.getPose()[partJoints[partNumber]];
+        switch (direction)
+        {
+        case X:
+            return &joint.x;
+        case Y:
+            return &joint.y;
+        default:
+            return &joint.z;
+        }
+    }
+
+    // Eklemler iskeletin cisim sırasıyla numaralanır: eklem i, i.
+    // cismi parent'ına bağlar (0 köktür, açısı kullanılmaz). Tüm poz
+    // jointCount() elemanlık tek bir Angles dizisidir.
+
+    int jointCount(void)
+    {
+        return skeleton.size();
+    }
+    int findJoint(const char *name)
+    {
+        // İskelet dosyasındaki parça adının eklemi, yoksa -1
+        Object *part = findPart(name);
+        return part ? skeleton.findNode(part) : -1;
+    }
+    Angles getJointAngle(int joint)
+    {
+        return skeleton.getPose()[joint];
+    }
+    void setJointAngle(int joint, Angles angles)
+    {
+        if (joint > 0)
+        {
+            skeleton.getPose()[joint] = angles;
+            skeleton.drive(joint);
+        }
+    }
+    void getJointAngles(Angles *angles)
+    {
+        // Tüm pozu tek seferde kopyalar
+        memcpy(angles, skeleton.getPose(), jointCount() * sizeof(Angles));
+    }
+    void setJointAngles(const Angles *angles)
+    {
+        // Kökün açısı hep 0 kalır. Şimdiye kadar sabit olan bir eklem
+        // değişiyorsa artık sürülen eklemdir.
+        Angles *pose = skeleton.getPose();
+        for (int joint = 1, count = jointCount(); joint < count; joint++)
+            if (!skeleton.isDriven(joint) && memcmp(&pose[joint], &angles[joint], sizeof(Angles)) != 0)
+            {
+                pose[joint] = angles[joint];
+                skeleton.drive(joint);
+            }
+        memcpy(pose + 1, angles + 1, (jointCount() - 1) * sizeof(Angles));
+    }
+
+    void startWalking(unsigned int a = 128)
+    {
+        // Döngü kaldığı yerden devam eder
+        walkingTotalAnimationIteration = a;
+        walkingStartTime = animationTime;
+        walkingStartPercent = walkingCompletionPercent;
+        walking = true;
+        fadeLayer(layers[LAYER_WALKING], animationTime, 1);
+    }
+    void stopWalking(void)
+    {
+        walking = false;
+        fadeLayer(layers[LAYER_WALKING], animationTime, 0);
+    }
+    void toggleWalking(void)
+    {
+        // ilk tıkta yürüme animasyonu başlatıyor,
+        // ikinci tıkta dolaşma animasyonu da başlatıyor,
+        // üçüncü tıkta ikisi de kapatılıyor
+        if (walking)
+        {
+            if (roaming)
+            {
+                stopWalking();
+                toggleRoaming();
+            }
+            else
+                startRoaming();
+        }
+        else
+            startWalking();
+    }
+    void walkAnimation(void)
+    {
+        if (!isLayerActive(LAYER_WALKING))
+            return;
+
+        walkingCompletionPercent = completionPercentAt(walkingStartTime, walkingStartPercent, walkingTotalAnimationIteration);
+
+        Pose &pose = layers[LAYER_WALKING].pose;
+        if (walkCycleTable.isBaked())
+            walkCycleTable.sample(walkingCompletionPercent, pose);
+        else
+            walkCycle(walkingCompletionPercent, pose);
+    }
+    static void walkCycle(double percent, Pose &pose)
+    {
+        // Animasyonun her karesi için animasyonun tamamlanma yüzdesi
+        // sinus fonksiyonundan geçirilerek animasyon lineer değil sinusoidal
+        // hale getiriliyor (ease-in-out)
+
+        // frameAngleX -40 ile 40 arasında değerler üretiyor. (tamamlanma yüzdesine göre)
+        // frameOffsetY -0.055 ile 0.045 arasında değerler üretiyor.
+
+        double frameAngleX = 40 * std::sin(percent * 360 * PI / 180);
+        double frameOffsetY = 0.05 * std::cos(percent * 2 * 360 * PI / 180) - 0.005;
+        // bu fonksiyonun periyodu ilk fonksiyonun periyodunun yarısı kadar
+
+        // Sol ve sağ bacak frameAngleX'in zıt işaretlileriyle eğiliyor.
+
+        pose.channels[poseChannel(RIGHT_FOOT, X)] = frameAngleX;
+        pose.channels[poseChannel(LEFT_FOOT, X)] = -frameAngleX;
+
+        // Modelin adım atma sırasında yükselip alçalması için;
+
+        pose.channels[POSE_ROOT_Y] = frameOffsetY;
+    }
+
+    void startRoaming(unsigned int a = 512)
+    {
+        roamingTotalAnimationIteration = a;
+        roamingStartTime = animationTime;
+        roamingStartPercent = roamingCompletionPercent;
+        roaming = true;
+        fadeLayer(layers[LAYER_ROAMING], animationTime, 1);
+    }
+    void stopRoaming(void)
+    {
+        // Model katman sönerken dinlenme konumuna geri döner
+        roaming = false;
+        fadeLayer(layers[LAYER_ROAMING], animationTime, 0);
+    }
+    void toggleRoaming(void)
+    {
+        if (roaming)
+            stopRoaming();
+        else
+            startRoaming();
+    }
+    void setRoamingCircle(Coordinates center, double radius)
+    {
+        // Dolaşma, sahnenin merkezi yerine center çevresinde verilen
+        // yarıçaplı bir çemberde yapılır (kalabalıkta her modelin yeri)
+        roamAround = true;
+        roamCenter = center;
+        roamScale = radius / ROAM_RADIUS;
+    }
+    void roamingAnimation(void)
+    {
+        if (!isLayerActive(LAYER_ROAMING))
+            return;
+
+        roamingCompletionPercent = completionPercentAt(roamingStartTime, roamingStartPercent, roamingTotalAnimationIteration);
+
+        Pose &pose = layers[LAYER_ROAMING].pose;
+        if (roamCycleTable.isBaked())
+            roamCycleTable.sample(roamingCompletionPercent, pose);
+        else
+            roamCycle(roamingCompletionPercent, pose);
+        if (roamAround)
+        {
+            pose.channels[POSE_ROOT_X] = roamCenter.x + pose.channels[POSE_ROOT_X] * roamScale;
+            pose.channels[POSE_ROOT_Z] = roamCenter.z + pose.channels[POSE_ROOT_Z] * roamScale;
+        }
+
+        // Modelin önünün sürekli dönmesi gerekiyor. (Lineer zamanlamalı bir animasyon olduğu için sin/cos yok,
+        // tabloya da alınmaz: açı döngü sonunda -360'tan 0'a atlar)
+        pose.channels[POSE_HEADING] = -roamingCompletionPercent * 360.0;
+    }
+    static void roamCycle(double percent, Pose &pose)
+    {
+        // dolaşma animasyonu modelin zeminde tur atmasını sağlıyor
+        // x ve z ekseninin alacağı değerler aynı fonksiyonun t(zaman)
+        // ekseninde çeyrek periyot kaydırılmasıyla bulunuyor.
+
+        double framePositionZ = ROAM_RADIUS * std::sin(percent * 360 * PI / 180);
+        pose.channels[POSE_ROOT_Z] = framePositionZ;
+
+        double framePositionX = ROAM_RADIUS * std::sin((percent + 0.25) * 360 * PI / 180);
+        pose.channels[POSE_ROOT_X] = framePositionX;
+    }
+
+    void startWaving(unsigned int a = 48)
+    {
+        wavingTotalAnimationIteration = a;
+        wavingStartTime = animationTime;
+        wavingStartPercent = wavingCompletionPercent;
+        waving = true;
+        fadeLayer(layers[LAYER_WAVING], animationTime, 1);
+    }
+    void stopWaving(void)
+    {
+        waving = false;
+        fadeLayer(layers[LAYER_WAVING], animationTime, 0);
+    }
+    void toggleWaving(void)
+    {
+        if (waving)
+            stopWaving();
+        else
+            startWaving();
+    }
+    void waveAnimation(void)
+    {
+        if (!isLayerActive(LAYER_WAVING))
+            return;
+
+        wavingCompletionPercent = completionPercentAt(wavingStartTime, wavingStartPercent, wavingTotalAnimationIteration);
+
+        Pose &pose = layers[LAYER_WAVING].pose;
+        if (waveCycleTable.isBaked())
+            waveCycleTable.sample(wavingCompletionPercent, pose);
+        else
+            waveCycle(wavingCompletionPercent, pose);
+    }
+    static void waveCycle(double percent, Pose &pose)
+    {
+        // El sallama animasyonu ease-in-out zamanlamalı bir animasyon olması
+        // gerektiği için sin/cos fonksiyonu kullanılıyor. (cos'un tercih sebebi 1.00'dan başlaması)
+
+        double frameAngleZ = -20 * std::cos(percent * 360 * PI / 180);
+
+        // Ön kol ve arka kol frameAngleZ'nin farklı katsayılarla
+        // ölçeklendirilmesiyle elde edilen değerlerle eğiliyor.
+        pose.channels[poseChannel(LEFT_ARM, Z)] = -frameAngleZ * 0.2 - 10;
+        pose.channels[poseChannel(LEFT_FOREARM, Z)] = -frameAngleZ + 70;
+
+        // BONUS: Toggle the code below instead of above
+        // setAngle(LEFT_ARM, Z, -frameAngleZ * 1.5);
+        // setAngle(LEFT_FOREARM, Z, frameAngleZ * 2);
+        // setAngle(RIGHT_ARM, Z, -frameAngleZ * 1.5);
+        // setAngle(RIGHT_FOREARM, Z, frameAngleZ * 2);
+    }
+
+    void playClip(const AnimationClip *clip)
+    {
+        // Klip, diğer animasyonların sürdüğü eklemleri de ezerek
+        // kaldığı yerden döngüye girer. (Klip katmanı en üsttedir)
+        if (!clip || clip->isEmpty())
+            return;
+        this->clip = clip;
+        clipStartTime = animationTime;
+        clipStartPercent = clipCompletionPercent;
+        clip->resetCursor(clipCursor);
+
+        // Klip yalnızca izi olan kanalları etkiler
+        PoseLayer &layer = layers[LAYER_CLIP];
+        memset(layer.mask, 0, sizeof(layer.mask));
+        for (int track = 0, count = clip->trackCount(); track < count; track++)
+            layer.mask[poseChannel(clip->getTrack(track).part, clip->getTrack(track).direction)] = 1;
+        clipPlaying = true;
+        fadeLayer(layer, animationTime, 1);
+    }
+    void stopClip(void)
+    {
+        clipPlaying = false;
+        fadeLayer(layers[LAYER_CLIP], animationTime, 0);
+    }
+    void toggleClip(const AnimationClip *clip)
+    {
+        if (clipPlaying)
+            stopClip();
+        else
+            playClip(clip);
+    }
+    void clipAnimation(void)
+    {
+        if (!clip || !isLayerActive(LAYER_CLIP))
+            return;
+
+        clipCompletionPercent = completionPercentAt(clipStartTime, clipStartPercent, clip->getLength());
+
+        // İmleç klibin o anki adımına getirilir ve her iz kendi eklemine
+        // uygulanır. (Ardışık karelerde anahtar araması yapılmaz)
+        clip->seek(clipCursor, clipCompletionPercent * clip->getLength());
+        for (int track = 0, count = clip->trackCount(); track < count; track++)
+        {
+            const ClipTrack &clipTrack = clip->getTrack(track);
+            layers[LAYER_CLIP].pose.channels[poseChannel(clipTrack.part, clipTrack.direction)] = clip->sample(clipCursor, track);
+        }
+    }
+};
+
+/////////////////////////////////////////////////////////////////// UZAK MODELLER (IMPOSTOR)
+
+/*
+Ekranda birkaç düzine pikselden kısa görünen bir model, yakındaki
+kadar üçgenle çizilir. ImpostorAtlas, modelin görüntülerini başlangıçta
+bir kez, ekran dışında (FBO) ve eski çizim yoluyla (Object::update) bir
+dokuya çizer: IMPOSTOR_VIEWS bakış açısı x (IMPOSTOR_WAVE_PHASES el
+sallama fazı + el sallamıyor) x (IMPOSTOR_WALK_PHASES yürüme fazı +
+yürümüyor). Uzaktaki modeller bu dokudan, kameraya dönük tek bir
+dörtgenle çizilir; hücre, kameranın modele göre açısı ve modelin
+fazlarıyla seçilir. Yürüme veya el sallaması açılıp kapanmakta olan
+(katmanı geçişte olan) modellerin hücresi yoktur, parçalarıyla çizilir.
+
+Görüntüler dikey izdüşümle (ortho), gövde merkezli ve kalabalığın
+kapsama küresi boyunda bir kareye çizilir; dörtgen de gövde merkezine
+aynı boyda yerleştirilir. Işık, kameranın -Z yönüne baktığı
+varsayılarak sahnedeki yönünden verilir.
+*/
+
+#define IMPOSTOR_VIEWS 8
+#define IMPOSTOR_WALK_PHASES 16
+#define IMPOSTOR_WAVE_PHASES 6
+#define IMPOSTOR_CELL 48    // hücrenin kenarı (piksel)
+#define IMPOSTOR_COLUMNS 32 // dokunun bir satırındaki hücre sayısı
+
+// Modelin impostor ile çizilmeye başladığı ekran boyu (piksel,
+// varsayılan; bkz. --impostors)
+#define IMPOSTOR_HEIGHT 32
+
+class ImpostorAtlas
+{
+private:
+    GLuint texture;
+    int width, height;
+
+    // Hücrelerin kapladığı, gövde merkezli karenin yarı kenarı
+    double radius;
+
+public:
+    ImpostorAtlas(void)
+    {
+        texture = 0;
+        width = height = 0;
+        radius = 0;
+    }
+    ~ImpostorAtlas(void)
+    {
+        glDeleteTextures(1, &texture);
+    }
+    ImpostorAtlas(const ImpostorAtlas &) = delete;
+    ImpostorAtlas &operator=(const ImpostorAtlas &) = delete;
+
+    bool bake(const Rig &rig, Coordinates light)
+    {
+        // OpenGL bağlamı ve ışık ayarları hazır olduktan sonra çağrılmalı
+        const int cells = IMPOSTOR_VIEWS * (IMPOSTOR_WAVE_PHASES + 1) * (IMPOSTOR_WALK_PHASES + 1);
+        width = IMPOSTOR_COLUMNS * IMPOSTOR_CELL;
+        height = (cells + IMPOSTOR_COLUMNS - 1) / IMPOSTOR_COLUMNS * IMPOSTOR_CELL;
+
+        GLint previousFramebuffer, viewport[4];
+        GLfloat clearColor[4];
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        GLuint framebuffer, depthBuffer;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+        if (complete)
+        {
+            // Boş pikseller saydamdır (dörtgende atılır)
+            glViewport(0, 0, width, height);
+            glClearColor(0, 0, 0, 0);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // Kapsama karesi, model yürüme ve el sallama katmanları
+            // tamamen açıkken (açılma geçişinden sonraki bir anda) ölçülür.
+            Human human;
+            human.init(rig);
+            human.startWalking();
+            human.startWaving();
+            human.animate(1.0);
+            human.evaluate();
+            Skeleton &skeleton = human.getSkeleton();
+            radius = skeleton.getSubtreeRadius(0) * 1.5;
+
+            // Hücrede her parça kendi ekran boyuna uygun seviyeyle çizilir
+            double pixelsPerUnit = IMPOSTOR_CELL / (2 * radius);
+            for (int node = 0; node < skeleton.size(); node++)
+                skeleton.getNode(node)->setLod(selectLodLevel(skeleton.getNode(node)->getLodRadius() * pixelsPerUnit, LOD_LEVELS - 1));
+
+            glMatrixMode(GL_PROJECTION);
+            glPushMatrix();
+            glLoadIdentity();
+            glOrtho(-radius, radius, -radius, radius, 0.1, 100);
+            glMatrixMode(GL_MODELVIEW);
+            glPushMatrix();
+
+            GLfloat lightPosition[] = {(GLfloat)light.x, (GLfloat)light.y, (GLfloat)light.z, 0};
+            for (int cell = 0; cell < cells; cell++)
+            {
+                // Model, kameranın onu view açısından görmesi için ters
+                // yöne çevrilir. Son faz sırası katmanın kapalı olduğu
+                // duruştur.
+                int walk = cell % (IMPOSTOR_WALK_PHASES + 1);
+                int wave = cell / (IMPOSTOR_WALK_PHASES + 1) % (IMPOSTOR_WAVE_PHASES + 1);
+                int view = cell / ((IMPOSTOR_WALK_PHASES + 1) * (IMPOSTOR_WAVE_PHASES + 1));
+                human.setCycleLayers(walk < IMPOSTOR_WALK_PHASES, wave < IMPOSTOR_WAVE_PHASES);
+                human.setCyclePhases((double)walk / IMPOSTOR_WALK_PHASES, (double)wave / IMPOSTOR_WAVE_PHASES);
+                human.setHeading(-view * 360.0 / IMPOSTOR_VIEWS);
+                human.animate(1.0);
+                human.evaluate();
+                Coordinates center = skeleton.getPosition(0);
+
+                glViewport(cell % IMPOSTOR_COLUMNS * IMPOSTOR_CELL, cell / IMPOSTOR_COLUMNS * IMPOSTOR_CELL, IMPOSTOR_CELL, IMPOSTOR_CELL);
+                glLoadIdentity();
+                gluLookAt(center.x, center.y, center.z + 10, center.x, center.y, center.z, 0, 1, 0);
+                glLightfv(GL_LIGHT0, GL_POSITION, lightPosition);
+                human.update();
+            }
+
+            glMatrixMode(GL_PROJECTION);
+            glPopMatrix();
+            glMatrixMode(GL_MODELVIEW);
+            glPopMatrix();
+
+            // Küçük görünen dörtgenler için ara seviyeler
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        glDeleteFramebuffers(1, &framebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        if (!complete)
+        {
+            glDeleteTextures(1, &texture);
+            texture = 0;
+        }
+        return complete;
+    }
+    bool isReady(void) const
+    {
+        return texture != 0;
+    }
+
+    static bool hasCell(double walkingWeight, double wavingWeight)
+    {
+        // Katmanları tamamen açık veya kapalı olan modeller dokudadır
+        return (walkingWeight == 0 || walkingWeight == 1) && (wavingWeight == 0 || wavingWeight == 1);
+    }
+    int cellAt(double viewAngle, double walking, double waving, double walkingWeight, double wavingWeight) const
+    {
+        // viewAngle: kameranın modelin önüne göre açısı (derece); model
+        // hasCell olmalı
+        int view = (int)std::floor(viewAngle / (360.0 / IMPOSTOR_VIEWS) + 0.5);
+        int walk = (int)std::floor(walking * IMPOSTOR_WALK_PHASES + 0.5);
+        int wave = (int)std::floor(waving * IMPOSTOR_WAVE_PHASES + 0.5);
+        view = (view % IMPOSTOR_VIEWS + IMPOSTOR_VIEWS) % IMPOSTOR_VIEWS;
+        walk = walkingWeight > 0 ? (walk % IMPOSTOR_WALK_PHASES + IMPOSTOR_WALK_PHASES) % IMPOSTOR_WALK_PHASES : IMPOSTOR_WALK_PHASES;
+        wave = wavingWeight > 0 ? (wave % IMPOSTOR_WAVE_PHASES + IMPOSTOR_WAVE_PHASES) % IMPOSTOR_WAVE_PHASES : IMPOSTOR_WAVE_PHASES;
+        return (view * (IMPOSTOR_WAVE_PHASES + 1) + wave) * (IMPOSTOR_WALK_PHASES + 1) + walk;
+    }
+    GLuint getTexture(void) const
+    {
+        return texture;
+    }
+    double getRadius(void) const
+    {
+        return radius;
+    }
+    double getCellWidth(void) const
+    {
+        // Bir hücrenin doku koordinatlarındaki boyu
+        return (double)IMPOSTOR_CELL / width;
+    }
+    double getCellHeight(void) const
+    {
+        return (double)IMPOSTOR_CELL / height;
+    }
+};
+
+/////////////////////////////////////////////////////////////////// TAMPON TABANLI ÇİZİCİ
+
+/*
+BufferRenderer, sabit fonksiyonlu (immediate mode) çizim yerine
+mesh'leri bir kere vertex/index tamponlarına (VBO) yükler ve her
+cismi tek bir glDrawElements ile çizer. Cismin model matrisi ve
+rengi shader'a uniform olarak verilir.
+
+Işıklandırma, Light sınıfının sabit fonksiyonlu hattaki ayarlarını
+(0.2 genel ortam + 0.2 ortam + 0.8 yayınık, yönlü ışık) taklit eder.
+
+Tek mesh'li (skinned) çizimde (--skinned) iskeletin tüm parçaları her
+ayrıntı seviyesi için tek bir mesh'te birleştirilir; her köşe, ait
+olduğu parçanın numarasını (kemik) ve rengini taşır. Kemik matrislerinin
+ilk üç satırı bir kayan noktalı dokuya yazılır (kemik başına üç RGBA
+texel) ve vertex shader köşeyi kendi kemiğinin matrisiyle taşır. Her
+modelin matrislerinin dokudaki başlangıcı örnek başına bir attribute
+olarak gelir; böylece bir modelin tamamı tek çizimde, aynı seviyedeki
+tüm modeller de tek bir glDrawElementsInstanced ile çizilir.
+
+Birleşik mesh'in seviyesi kökün (gövde) ekrandaki yarıçapıyla seçilir.
+Her seviyede diğer parçalar, gövde o seviyenin en büyük yarıçapındayken
+kendi boylarına göre seçilecek seviyeyle eklenir; böylece gözler gibi
+küçük parçalar gövdeyle aynı ayrıntıda çizilmez.
+*/
+
+#define RENDERER_LEGACY 0
+#define RENDERER_BUFFERS 1
+
+typedef struct gpuMesh
+{
+    GLuint vao, vertexBuffer, indexBuffer, colorBuffer;
+    GLsizei indexCount;
+} GPUMesh;
+
+// Örnekli çizimde her örnek için tampona yazılan float sayısı:
+// model matrisi (16) + renk (4)
+#define INSTANCE_FLOATS 20
+
+// Tek mesh'li çizimde köşe başına float sayısı: konum (3) + normal (3)
+// + renk (4) + kemik (1); kemik başına float sayısı (3 satır) ve kemik
+// dokusunun en büyük genişliği (texel)
+#define SKINNED_VERTEX_FLOATS 11
+#define BONE_FLOATS 12
+#define BONE_TEXTURE_WIDTH 4096
+
+// Uzak model (impostor) başına float sayısı: gövde merkezi (3) + hücre
+// sütunu ve satırı (2)
+#define IMPOSTOR_FLOATS 5
+
+// Kalabalıkta model başına yayımlanan float sayısı: yürüme ve el
+// sallama fazı (2) + yürüme ve el sallama katmanının ağırlığı (2)
+#define PHASE_FLOATS 4
+
+class BufferRenderer
+{
+private:
+    GLuint program;
+    GLint modelLocation, viewLocation, projectionLocation;
+    GLint colorLocation, lightDirectionLocation;
+
+    // Örnekli çizim programı; model matrisi ve renk uniform
+    // yerine örnek başına vertex attribute olarak gelir.
+    GLuint instancedProgram;
+    GLint instancedViewLocation, instancedProjectionLocation;
+    GLint instancedLightDirectionLocation;
+    GLuint instanceBuffer;
+
+    // Tek mesh'li çizim programı, her ayrıntı seviyesinin birleşik
+    // mesh'i, kemik dokusu ve modellerin dokudaki başlangıçları
+    GLuint skinnedProgram;
+    GLint skinnedViewLocation, skinnedProjectionLocation;
+    GLint skinnedLightDirectionLocation;
+    GLint boneTextureLocation, boneTextureSizeLocation;
+    GPUMesh skinnedMeshes[LOD_LEVELS];
+    int boneCount;
+    GLuint boneTexture, originBuffer;
+    int boneTextureWidth, boneTextureHeight, maxTextureSize;
+    std::vector<GLfloat> origins;
+
+    // Uzak modellerin dörtgenleri: köşeler ve örnek başına veriler
+    GLuint impostorProgram;
+    GLint impostorViewLocation, impostorProjectionLocation;
+    GLint impostorAtlasLocation, impostorCellLocation, impostorRadiusLocation;
+    GLuint impostorVao, impostorCornerBuffer, impostorBuffer;
+
+    // Her Mesh için bir kere oluşturulan tamponlar
+    std::map<const Mesh *, GPUMesh> meshes;
+
+    static GLuint compile(GLenum type, const char *source)
+    {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+
+        GLint compiled;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if (!compiled)
+        {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+            std::cerr << "shader derlenemedi: " << log << std::endl;
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    static GLuint link(const char *vertexSource, const char *fragmentSource)
+    {
+        GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource);
+        GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource);
+        if (!vertexShader || !fragmentShader)
+            return 0;
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        // Programda olmayan isimler yok sayılır. Örnekli çizimde mat4
+        // attribute 2, 3, 4, 5 konumlarını kaplar; tek mesh'li çizim
+        // aynı konumları kendi attribute'ları için kullanır.
+        glBindAttribLocation(program, 0, "position");
+        glBindAttribLocation(program, 1, "normal");
+        glBindAttribLocation(program, 2, "instanceModel");
+        glBindAttribLocation(program, 6, "instanceColor");
+        glBindAttribLocation(program, 2, "vertexColor");
+        glBindAttribLocation(program, 3, "bone");
+        glBindAttribLocation(program, 4, "boneOrigin");
+        glBindAttribLocation(program, 0, "corner");
+        glBindAttribLocation(program, 1, "impostorCenter");
+        glBindAttribLocation(program, 2, "impostorCell");
+        glBindAttribLocation(program, 7, "vertexTint");
+        glLinkProgram(program);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        GLint linked;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            char log[1024];
+            glGetProgramInfoLog(program, sizeof(log), NULL, log);
+            std::cerr << "shader programı bağlanamadı: " << log << std::endl;
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    void setLight(GLint location, const Matrix4 &view, Coordinates light)
+    {
+        // Yönlü ışık, sabit fonksiyonlu hatta olduğu gibi kamera
+        // uzayına taşınır.
+        double lx = view.m[0] * light.x + view.m[4] * light.y + view.m[8] * light.z;
+        double ly = view.m[1] * light.x + view.m[5] * light.y + view.m[9] * light.z;
+        double lz = view.m[2] * light.x + view.m[6] * light.y + view.m[10] * light.z;
+        double lightLength = std::sqrt(lx * lx + ly * ly + lz * lz);
+        glUniform3f(location, lx / lightLength, ly / lightLength, lz / lightLength);
+    }
+
+    static void releaseMesh(GPUMesh &gpu)
+    {
+        // Sıfır isimler GL tarafından yok sayılır
+        glDeleteVertexArrays(1, &gpu.vao);
+        GLuint buffers[] = {gpu.vertexBuffer, gpu.indexBuffer, gpu.colorBuffer};
+        glDeleteBuffers(3, buffers);
+        gpu.vao = gpu.vertexBuffer = gpu.indexBuffer = gpu.colorBuffer = 0;
+        gpu.indexCount = 0;
+    }
+
+    const GPUMesh &upload(const Mesh *mesh)
+    {
+        std::map<const Mesh *, GPUMesh>::iterator found = meshes.find(mesh);
+        if (found != meshes.end())
+            return found->second;
+
+        GPUMesh &gpu = meshes[mesh];
+        gpu.indexCount = (GLsizei)mesh->indices.size();
+
+        glGenVertexArrays(1, &gpu.vao);
+        glBindVertexArray(gpu.vao);
+
+        glGenBuffers(1, &gpu.vertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, gpu.vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, mesh->vertices.size() * sizeof(GLfloat), &mesh->vertices[0], GL_STATIC_DRAW);
+
+        glGenBuffers(1, &gpu.indexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->indices.size() * sizeof(GLuint), &mesh->indices[0], GL_STATIC_DRAW);
+
+        // 0: konum, 1: normal (bkz. Mesh)
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (const GLvoid *)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (const GLvoid *)(3 * sizeof(GLfloat)));
+
+        // 7: birleşik mesh'in köşe renkleri. Renksiz mesh'lerde dizi
+        // kapalıdır ve çizimden önce verilen sabit değer (beyaz) okunur.
+        gpu.colorBuffer = 0;
+        if (!mesh->colors.empty())
+        {
+            glGenBuffers(1, &gpu.colorBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, gpu.colorBuffer);
+            glBufferData(GL_ARRAY_BUFFER, mesh->colors.size() * sizeof(GLfloat), &mesh->colors[0], GL_STATIC_DRAW);
+            glEnableVertexAttribArray(7);
+            glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (const GLvoid *)0);
+        }
+
+        // Sabit fonksiyonlu hattın istemci dizileri (Mesh::draw) bağlı
+        // tampon kalırsa işaretçileri tampon içi konum sanır.
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return gpu;
+    }
+
+public:
+    BufferRenderer(void)
+    {
+        program = instancedProgram = skinnedProgram = 0;
+        instanceBuffer = 0;
+        boneCount = 0;
+        boneTexture = originBuffer = 0;
+        boneTextureWidth = boneTextureHeight = maxTextureSize = 0;
+        impostorProgram = 0;
+        impostorVao = impostorCornerBuffer = impostorBuffer = 0;
+        for (int level = 0; level < LOD_LEVELS; level++)
+            skinnedMeshes[level].vao = skinnedMeshes[level].vertexBuffer = skinnedMeshes[level].indexBuffer =
+                skinnedMeshes[level].colorBuffer = 0;
+    }
+    ~BufferRenderer(void)
+    {
+        release();
+    }
+    BufferRenderer(const BufferRenderer &) = delete;
+    BufferRenderer &operator=(const BufferRenderer &) = delete;
+
+    // Programları, tamponları ve dokuları siler; kıyaslamada her sahnenin
+    // çizicisi bir sonraki sahneden önce, bağlam hâlâ etkinken yok edilir.
+    void release(void)
+    {
+        for (std::map<const Mesh *, GPUMesh>::iterator it = meshes.begin(); it != meshes.end(); ++it)
+            releaseMesh(it->second);
+        meshes.clear();
+        for (int level = 0; level < LOD_LEVELS; level++)
+            releaseMesh(skinnedMeshes[level]);
+
+        glDeleteProgram(program);
+        glDeleteProgram(instancedProgram);
+        glDeleteProgram(skinnedProgram);
+        glDeleteProgram(impostorProgram);
+        program = instancedProgram = skinnedProgram = impostorProgram = 0;
+
+        GLuint buffers[] = {instanceBuffer, originBuffer, impostorCornerBuffer, impostorBuffer};
+        glDeleteBuffers(4, buffers);
+        instanceBuffer = originBuffer = impostorCornerBuffer = impostorBuffer = 0;
+        glDeleteVertexArrays(1, &impostorVao);
+        impostorVao = 0;
+        glDeleteTextures(1, &boneTexture);
+        boneTexture = 0;
+        boneCount = 0;
+        boneTextureWidth = boneTextureHeight = 0;
+    }
+
+    bool init(void)
+    {
+        const char *vertexSource =
+            "#version 120\n"
+            "uniform mat4 model;\n"
+            "uniform mat4 view;\n"
+            "uniform mat4 projection;\n"
+            "uniform vec4 color;\n"
+            "uniform vec3 lightDirection;\n"
+            "attribute vec3 position;\n"
+            "attribute vec3 normal;\n"
+            "attribute vec3 vertexTint;\n"
+            "varying vec4 shade;\n"
+            "void main()\n"
+            "{\n"
+            "    mat4 modelView = view * model;\n"
+            "    vec3 n = normalize(mat3(modelView) * normal);\n"
+            "    float diffuse = max(dot(n, lightDirection), 0.0);\n"
+            "    shade = vec4(min(color.rgb * vertexTint * (0.4 + 0.8 * diffuse), 1.0), color.a);\n"
+            "    gl_Position = projection * modelView * vec4(position, 1.0);\n"
+            "}\n";
+        const char *instancedVertexSource =
+            "#version 120\n"
+            "uniform mat4 view;\n"
+            "uniform mat4 projection;\n"
+            "uniform vec3 lightDirection;\n"
+            "attribute vec3 position;\n"
+            "attribute vec3 normal;\n"
+            "attribute mat4 instanceModel;\n"
+            "attribute vec4 instanceColor;\n"
+            "attribute vec3 vertexTint;\n"
+            "varying vec4 shade;\n"
+            "void main()\n"
+            "{\n"
+            "    mat4 modelView = view * instanceModel;\n"
+            "    vec3 n = normalize(mat3(modelView) * normal);\n"
+            "    float diffuse = max(dot(n, lightDirection), 0.0);\n"
+            "    shade = vec4(min(instanceColor.rgb * vertexTint * (0.4 + 0.8 * diffuse), 1.0), instanceColor.a);\n"
+            "    gl_Position = projection * modelView * vec4(position, 1.0);\n"
+            "}\n";
+        const char *fragmentSource =
+            "#version 120\n"
+            "varying vec4 shade;\n"
+            "void main()\n"
+            "{\n"
+            "    gl_FragColor = shade;\n"
+            "}\n";
+
+        program = link(vertexSource, fragmentSource);
+        instancedProgram = link(instancedVertexSource, fragmentSource);
+        if (!program || !instancedProgram)
+            return false;
+
+        modelLocation = glGetUniformLocation(program, "model");
+        viewLocation = glGetUniformLocation(program, "view");
+        projectionLocation = glGetUniformLocation(program, "projection");
+        colorLocation = glGetUniformLocation(program, "color");
+        lightDirectionLocation = glGetUniformLocation(program, "lightDirection");
+
+        instancedViewLocation = glGetUniformLocation(instancedProgram, "view");
+        instancedProjectionLocation = glGetUniformLocation(instancedProgram, "projection");
+        instancedLightDirectionLocation = glGetUniformLocation(instancedProgram, "lightDirection");
+        glGenBuffers(1, &instanceBuffer);
+        return true;
+    }
+
+    void draw(const std::vector<DrawItem> &items, const Matrix4 &view, const Matrix4 &projection, Coordinates light)
+    {
+        glUseProgram(program);
+        glUniformMatrix4fv(viewLocation, 1, GL_FALSE, view.m);
+        glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, projection.m);
+        setLight(lightDirectionLocation, view, light);
+        glVertexAttrib3f(7, 1, 1, 1);
+
+        for (unsigned int i = 0, length = items.size(); i < length; i++)
+        {
+            const DrawItem &item = items[i];
+            const GPUMesh &gpu = upload(item.mesh);
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, item.model.m);
+            glUniform4f(colorLocation, item.color.red, item.color.green, item.color.blue, item.color.alpha);
+            glBindVertexArray(gpu.vao);
+            glDrawElements(GL_TRIANGLES, gpu.indexCount, GL_UNSIGNED_INT, (const GLvoid *)0);
+        }
+
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+    void drawInstanced(
+        const std::vector<InstanceBatch> &batches, const std::vector<GLfloat> &instances,
+        const Matrix4 &view, const Matrix4 &projection, Coordinates light)
+    {
+        // instances dizisi parça parça sıralanmıştır: önce tüm
+        // modellerin 0. parçası, sonra tüm modellerin 1. parçası...
+        // Her parçanın örnekleri de ayrıntı seviyelerine göre
+        // gruplanmıştır. Böylece her parçanın her seviyesi (örneğin
+        // uzaktaki tüm sol önkollar) tek bir glDrawElementsInstanced
+        // ile çizilir.
+
+        if (instances.empty())
+            return;
+
+        glUseProgram(instancedProgram);
+        glUniformMatrix4fv(instancedViewLocation, 1, GL_FALSE, view.m);
+        glUniformMatrix4fv(instancedProjectionLocation, 1, GL_FALSE, projection.m);
+        setLight(instancedLightDirectionLocation, view, light);
+        glVertexAttrib3f(7, 1, 1, 1);
+
+        // Her karede tampon yeniden ayrılarak (orphaning) sürücünün
+        // önceki karenin çizimini beklemesi önlenir.
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(GLfloat), &instances[0]);
+
+        const GLsizei stride = INSTANCE_FLOATS * sizeof(GLfloat);
+        for (unsigned int i = 0, length = batches.size(); i < length; i++)
+        {
+            const InstanceBatch &batch = batches[i];
+            if (batch.count == 0)
+                continue;
+
+            const GPUMesh &gpu = upload(batch.mesh);
+            glBindVertexArray(gpu.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+            size_t offset = (size_t)batch.first * stride;
+            for (int column = 0; column < 4; column++)
+            {
+                glEnableVertexAttribArray(2 + column);
+                glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(offset + column * 4 * sizeof(GLfloat)));
+                glVertexAttribDivisor(2 + column, 1);
+            }
+            glEnableVertexAttribArray(6);
+            glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(offset + 16 * sizeof(GLfloat)));
+            glVertexAttribDivisor(6, 1);
+
+            glDrawElementsInstanced(GL_TRIANGLES, gpu.indexCount, GL_UNSIGNED_INT, (const GLvoid *)0, batch.count);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glUseProgram(0);
+    }
+
+    bool initSkinning(Skeleton &skeleton)
+    {
+        // init'ten sonra çağrılmalı. Vertex shader'da doku okuması ve
+        // kayan noktalı doku (GL 3.0 veya ARB_texture_float) gerekir.
+        GLint vertexTextureUnits = 0;
+        glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &vertexTextureUnits);
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+        const char *version = (const char *)glGetString(GL_VERSION);
+        const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+        bool floatTextures = (version && atoi(version) >= 3) || (extensions && strstr(extensions, "GL_ARB_texture_float"));
+        if (vertexTextureUnits < 1 || !floatTextures)
+            return false;
+
+        // Kemik dokusunun bir satırına tam sayıda model sığar
+        boneCount = skeleton.size();
+        int modelTexels = boneCount * 3;
+        boneTextureWidth = std::min(maxTextureSize, BONE_TEXTURE_WIDTH) / modelTexels * modelTexels;
+        if (boneTextureWidth == 0)
+            return false;
+
+        const char *vertexSource =
+            "#version 120\n"
+            "uniform mat4 view;\n"
+            "uniform mat4 projection;\n"
+            "uniform vec3 lightDirection;\n"
+            "uniform sampler2D bones;\n"
+            "uniform vec2 boneTextureSize;\n"
+            "attribute vec3 position;\n"
+            "attribute vec3 normal;\n"
+            "attribute vec4 vertexColor;\n"
+            "attribute float bone;\n"
+            "attribute vec2 boneOrigin;\n"
+            "varying vec4 shade;\n"
+            "vec4 boneRow(float row)\n"
+            "{\n"
+            "    vec2 texel = vec2(boneOrigin.x + bone * 3.0 + row + 0.5, boneOrigin.y + 0.5);\n"
+            "    return texture2DLod(bones, texel / boneTextureSize, 0.0);\n"
+            "}\n"
+            "void main()\n"
+            "{\n"
+            "    vec4 row0 = boneRow(0.0), row1 = boneRow(1.0), row2 = boneRow(2.0);\n"
+            "    vec4 local = vec4(position, 1.0);\n"
+            "    vec4 world = vec4(dot(row0, local), dot(row1, local), dot(row2, local), 1.0);\n"
+            "    vec3 worldNormal = vec3(dot(row0.xyz, normal), dot(row1.xyz, normal), dot(row2.xyz, normal));\n"
+            "    vec3 n = normalize(mat3(view) * worldNormal);\n"
+            "    float diffuse = max(dot(n, lightDirection), 0.0);\n"
+            "    shade = vec4(min(vertexColor.rgb * (0.4 + 0.8 * diffuse), 1.0), vertexColor.a);\n"
+            "    gl_Position = projection * view * world;\n"
+            "}\n";
+        const char *fragmentSource =
+            "#version 120\n"
+            "varying vec4 shade;\n"
+            "void main()\n"
+            "{\n"
+            "    gl_FragColor = shade;\n"
+            "}\n";
+        skinnedProgram = link(vertexSource, fragmentSource);
+        if (!skinnedProgram)
+            return false;
+        skinnedViewLocation = glGetUniformLocation(skinnedProgram, "view");
+        skinnedProjectionLocation = glGetUniformLocation(skinnedProgram, "projection");
+        skinnedLightDirectionLocation = glGetUniformLocation(skinnedProgram, "lightDirection");
+        boneTextureLocation = glGetUniformLocation(skinnedProgram, "bones");
+        boneTextureSizeLocation = glGetUniformLocation(skinnedProgram, "boneTextureSize");
+
+        glGenBuffers(1, &originBuffer);
+        double rootRadius = std::max(skeleton.getNode(0)->getBoundingRadius(), 1e-6);
+        for (int level = 0; level < LOD_LEVELS; level++)
+        {
+            // Parçaların mesh'leri kemik numaraları ve renkleriyle arka
+            // arkaya eklenir. (0. seviyenin üst sınırı olmadığı için
+            // orada tüm parçalar en ayrıntılı haliyle eklenir.)
+            std::vector<GLfloat> vertices;
+            std::vector<GLuint> indices;
+            for (int node = 0; node < boneCount; node++)
+            {
+                int partLevel = 0;
+                if (level > 0)
+                {
+                    double pixelRadius = lodPixelRadius[level - 1] * skeleton.getNode(node)->getBoundingRadius() / rootRadius;
+                    partLevel = selectLodLevel(pixelRadius, LOD_LEVELS - 1);
+                }
+                const Mesh *mesh = skeleton.getNode(node)->getLodMesh(partLevel);
+                RGBA color = skeleton.getNode(node)->getColor();
+                GLuint first = vertices.size() / SKINNED_VERTEX_FLOATS;
+                for (size_t v = 0; v < mesh->vertices.size(); v += 6)
+                {
+                    vertices.insert(vertices.end(), mesh->vertices.begin() + v, mesh->vertices.begin() + v + 6);
+                    vertices.push_back(color.red);
+                    vertices.push_back(color.green);
+                    vertices.push_back(color.blue);
+                    vertices.push_back(color.alpha);
+                    vertices.push_back(node);
+                }
+                for (size_t i = 0; i < mesh->indices.size(); i++)
+                    indices.push_back(first + mesh->indices[i]);
+            }
+
+            GPUMesh &gpu = skinnedMeshes[level];
+            gpu.indexCount = (GLsizei)indices.size();
+            glGenVertexArrays(1, &gpu.vao);
+            glBindVertexArray(gpu.vao);
+
+            glGenBuffers(1, &gpu.vertexBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, gpu.vertexBuffer);
+            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), &vertices[0], GL_STATIC_DRAW);
+
+            glGenBuffers(1, &gpu.indexBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.indexBuffer);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+
+            // 0: konum, 1: normal, 2: renk, 3: kemik, 4: kemik başlangıcı (örnek başına)
+            const GLsizei stride = SKINNED_VERTEX_FLOATS * sizeof(GLfloat);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)0);
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(3 * sizeof(GLfloat)));
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(6 * sizeof(GLfloat)));
+            glEnableVertexAttribArray(3);
+            glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(10 * sizeof(GLfloat)));
+            glEnableVertexAttribArray(4);
+            glVertexAttribDivisor(4, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // Doku her karede yeniden yazılır; yüksekliği model sayısıyla büyür
+        glGenTextures(1, &boneTexture);
+        glBindTexture(GL_TEXTURE_2D, boneTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        boneTextureHeight = 0;
+        return true;
+    }
+    bool isSkinned(void)
+    {
+        return skinnedProgram != 0;
+    }
+    int getSkinnedCapacity(void)
+    {
+        // Kemik dokusuna (en çok maxTextureSize satır) sığan model sayısı
+        if (boneCount == 0)
+            return 0;
+        return boneTextureWidth / (boneCount * 3) * maxTextureSize;
+    }
+
+    void drawSkinned(
+        const std::vector<GLfloat> &bones, const int *levelCounts,
+        const Matrix4 &view, const Matrix4 &projection, Coordinates light)
+    {
+        // bones, modellerin kemik satırlarını (model başına boneCount *
+        // BONE_FLOATS) ayrıntı seviyelerine göre sıralı tutar;
+        // levelCounts her seviyedeki model sayısıdır. Her seviye tek
+        // çizimdir.
+        int models = bones.size() / (boneCount * BONE_FLOATS);
+        if (models == 0)
+            return;
+
+        int modelTexels = boneCount * 3;
+        int modelsPerRow = boneTextureWidth / modelTexels;
+        int rows = (models + modelsPerRow - 1) / modelsPerRow;
+        if (rows > maxTextureSize)
+            return; // getSkinnedCapacity ile başlangıçta denetlenir
+
+        glBindTexture(GL_TEXTURE_2D, boneTexture);
+        if (rows > boneTextureHeight)
+        {
+            boneTextureHeight = rows;
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F_ARB, boneTextureWidth, boneTextureHeight, 0, GL_RGBA, GL_FLOAT, NULL);
+        }
+        int fullRows = models / modelsPerRow, rest = models % modelsPerRow;
+        if (fullRows > 0)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, boneTextureWidth, fullRows, GL_RGBA, GL_FLOAT, &bones[0]);
+        if (rest > 0)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, fullRows, rest * modelTexels, 1, GL_RGBA, GL_FLOAT,
+                            &bones[(size_t)fullRows * boneTextureWidth * 4]);
+
+        // Her modelin ilk kemiğinin texel'i
+        origins.resize(models * 2);
+        for (int model = 0; model < models; model++)
+        {
+            origins[model * 2] = (model % modelsPerRow) * modelTexels;
+            origins[model * 2 + 1] = model / modelsPerRow;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, originBuffer);
+        glBufferData(GL_ARRAY_BUFFER, origins.size() * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, origins.size() * sizeof(GLfloat), &origins[0]);
+
+        glUseProgram(skinnedProgram);
+        glUniformMatrix4fv(skinnedViewLocation, 1, GL_FALSE, view.m);
+        glUniformMatrix4fv(skinnedProjectionLocation, 1, GL_FALSE, projection.m);
+        setLight(skinnedLightDirectionLocation, view, light);
+        glUniform1i(boneTextureLocation, 0);
+        glUniform2f(boneTextureSizeLocation, boneTextureWidth, boneTextureHeight);
+
+        for (int level = 0, first = 0; level < LOD_LEVELS; first += levelCounts[level], level++)
+        {
+            if (levelCounts[level] == 0)
+                continue;
+            const GPUMesh &gpu = skinnedMeshes[level];
+            glBindVertexArray(gpu.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, originBuffer);
+            glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (const GLvoid *)(first * 2 * sizeof(GLfloat)));
+            glDrawElementsInstanced(GL_TRIANGLES, gpu.indexCount, GL_UNSIGNED_INT, (const GLvoid *)0, levelCounts[level]);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glUseProgram(0);
+    }
+
+    bool initImpostors(void)
+    {
+        // init'ten sonra çağrılmalı
+        const char *vertexSource =
+            "#version 120\n"
+            "uniform mat4 view;\n"
+            "uniform mat4 projection;\n"
+            "uniform vec2 cellSize;\n"
+            "uniform float radius;\n"
+            "attribute vec2 corner;\n"
+            "attribute vec3 impostorCenter;\n"
+            "attribute vec2 impostorCell;\n"
+            "varying vec2 coordinate;\n"
+            "void main()\n"
+            "{\n"
+            "    coordinate = (impostorCell + corner * 0.5 + 0.5) * cellSize;\n"
+            "    vec4 center = view * vec4(impostorCenter, 1.0);\n"
+            "    gl_Position = projection * (center + vec4(corner * radius, 0.0, 0.0));\n"
+            "}\n";
+        const char *fragmentSource =
+            "#version 120\n"
+            "uniform sampler2D atlas;\n"
+            "varying vec2 coordinate;\n"
+            "void main()\n"
+            "{\n"
+            "    vec4 color = texture2D(atlas, coordinate);\n"
+            "    if (color.a < 0.5)\n"
+            "        discard;\n"
+            "    gl_FragColor = vec4(color.rgb / color.a, 1.0);\n"
+            "}\n";
+        impostorProgram = link(vertexSource, fragmentSource);
+        if (!impostorProgram)
+            return false;
+        impostorViewLocation = glGetUniformLocation(impostorProgram, "view");
+        impostorProjectionLocation = glGetUniformLocation(impostorProgram, "projection");
+        impostorAtlasLocation = glGetUniformLocation(impostorProgram, "atlas");
+        impostorCellLocation = glGetUniformLocation(impostorProgram, "cellSize");
+        impostorRadiusLocation = glGetUniformLocation(impostorProgram, "radius");
+
+        // İki üçgenlik dörtgen (şerit)
+        const GLfloat corners[] = {-1, -1, 1, -1, -1, 1, 1, 1};
+        glGenVertexArrays(1, &impostorVao);
+        glBindVertexArray(impostorVao);
+        glGenBuffers(1, &impostorCornerBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, impostorCornerBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (const GLvoid *)0);
+
+        // 1: gövde merkezi, 2: hücre (örnek başına)
+        const GLsizei stride = IMPOSTOR_FLOATS * sizeof(GLfloat);
+        glGenBuffers(1, &impostorBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, impostorBuffer);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)0);
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(3 * sizeof(GLfloat)));
+        glVertexAttribDivisor(2, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return true;
+    }
+
+    void drawImpostors(const std::vector<GLfloat> &impostors, const ImpostorAtlas &atlas, const Matrix4 &view, const Matrix4 &projection)
+    {
+        // Tüm uzak modeller tek çizimle, kameraya dönük dörtgenler
+        // olarak çizilir (bkz. ImpostorAtlas).
+        int count = impostors.size() / IMPOSTOR_FLOATS;
+        if (count == 0 || !impostorProgram)
+            return;
+
+        glBindBuffer(GL_ARRAY_BUFFER, impostorBuffer);
+        glBufferData(GL_ARRAY_BUFFER, impostors.size() * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, impostors.size() * sizeof(GLfloat), &impostors[0]);
+
+        glUseProgram(impostorProgram);
+        glUniformMatrix4fv(impostorViewLocation, 1, GL_FALSE, view.m);
+        glUniformMatrix4fv(impostorProjectionLocation, 1, GL_FALSE, projection.m);
+        glUniform1i(impostorAtlasLocation, 0);
+        glUniform2f(impostorCellLocation, atlas.getCellWidth(), atlas.getCellHeight());
+        glUniform1f(impostorRadiusLocation, atlas.getRadius());
+        glBindTexture(GL_TEXTURE_2D, atlas.getTexture());
+
+        glBindVertexArray(impostorVao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glUseProgram(0);
+    }
+};
+
+/////////////////////////////////////////////////////////////////// KALABALIK
+
+/*
+Crowd, yük testleri için çok sayıda Human nesnesini ızgara
+şeklinde dizer. Her modelin kendi konumu, yönü ve animasyon
+fazı vardır. Her karede tüm modellerin animasyonları ilerletilir
+ve parçaların model matrisleri, örnekli çizim için parça parça
+sıralanmış tek bir diziye yazılır. Uzaktaki modeller (--impostors)
+parçalarıyla değil, ImpostorAtlas'tan tek dörtgenle çizilir.
+
+Modellerin kapsama küreleri çizim tarafında bir SpatialGrid'de tutulur;
+görüş alanındaki ve göze yakın modeller ızgaradan sorgulanır. Simülasyon
+her adımda yalnızca ızgaraya bildirdiği yerden CROWD_GRID_SLACK'ten
+fazla uzaklaşan modelleri bildirir, ızgarada da yalnızca onların kaydı
+güncellenir (küreler bu pay kadar geniş tutulur). Modeller dolaşırken
+(--crowd-roam, sağ tık) kendi yerlerinin çevresinde tur atar; sol tıkla
+imlecin altındaki model ızgarada ışınla bulunur (pick).
+*/
+
+// Kalabalıkta işçilere dağıtılan model grubunun boyu
+#define CROWD_GRAIN 256
+
+// Bir modelin ızgaraya yeni yerinin bildirilmesi için kayıtlı
+// merkezinden uzaklaşması gereken mesafe
+#define CROWD_GRID_SLACK 0.5
+
+// Dolaşan modellerin çemberinin yarıçapı (modeller arası uzaklığa oranı)
+#define CROWD_ROAM_RADIUS 0.4
+
+// Izgaradaki kaydı güncellenecek model ve kapsama küresinin yeni merkezi
+typedef struct actorMove
+{
+    int actor;
+    Coordinates center;
+} ActorMove;
+
+class Crowd
+{
+private:
+    // Human nesneleri kendi Object'lerini pointer'larla birbirine
+    // bağladığı için bu vektör init'ten sonra büyütülmemelidir.
+    std::vector<Human> humans;
+
+    // Tüm modellerin iskeletleri birlikte (SIMD ile) hesaplanır. Toplu
+    // diziler simülasyonun karelerindedir (bkz. FrameSnapshot); animate
+    // simülasyon, update çizim tarafında çağrılır.
+    bool useSimd;
+
+    // İlk modelin ayrı çizilen parçaları (mesh'ler, renkler ve sınır
+    // küreleri tüm modellerde aynıdır; birleşik mesh'e katılanlar
+    // yoktur), iskeletteki sıraları ve her modelin her parçasının
+    // seçili ayrıntı seviyesi ([parça][model])
+    std::vector<Object *> parts;
+    std::vector<int> partNodes;
+    std::vector<unsigned char> lodLevels;
+
+    // Bir modelin gövde merkezinden animasyon sırasında en fazla ne
+    // kadar uzağa uzanabileceği ve son testte görünen modeller
+    double actorRadius;
+    std::vector<unsigned char> actorVisible;
+
+    // Modellerin kapsama kürelerinin ızgarası ile son sorguların
+    // sonuçları (çizim tarafı) ve her modelin ızgaraya son bildirilen
+    // merkezi (simülasyon tarafı). Çizim hazırlığının tüm adımları
+    // yalnızca görünen modelleri (drawnActors: parçalarıyla,
+    // impostorActors: dörtgenle çizilenler) dolaşır.
+    SpatialGrid grid;
+    std::vector<int> visibleActors, nearActors;
+    std::vector<int> drawnActors, impostorActors;
+    std::vector<Coordinates> gridCenters;
+    std::mutex movesLock;
+
+    // Tek mesh'li çizimde her modelin tamamı bir ayrıntı seviyesiyle
+    // çizilir (bkz. updateSkinned)
+    bool skinned;
+    std::vector<unsigned char> actorLevels;
+    std::vector<int> actorSlots;
+
+    // Ekranda impostorHeight pikselden kısa görünen modeller atlas'tan
+    // çizilir (atlas NULL ise hiçbiri)
+    const ImpostorAtlas *atlas;
+    double impostorHeight;
+    std::vector<unsigned char> actorNear;
+
+    // Seçimde (pick) ışının denendiği, son update'teki pozlar
+    SkeletonBatch *pickBatch;
+
+public:
+    // Örnek verileri ve çizim grupları (bkz. BufferRenderer::drawInstanced)
+    std::vector<GLfloat> instances;
+    std::vector<InstanceBatch> batches;
+
+    // Tek mesh'li çizimde kemik satırları ve seviye başına model sayısı
+    // (bkz. BufferRenderer::drawSkinned)
+    std::vector<GLfloat> bones;
+    int levelCounts[LOD_LEVELS];
+
+    // Uzak modellerin dörtgenleri (bkz. BufferRenderer::drawImpostors)
+    std::vector<GLfloat> impostors;
+
+    Crowd(void)
+    {
+        useSimd = true;
+        actorRadius = 0;
+        skinned = false;
+        atlas = NULL;
+        impostorHeight = 0;
+        pickBatch = NULL;
+        std::fill(levelCounts, levelCounts + LOD_LEVELS, 0);
+    }
+
+    void init(int count, const Rig &rig, const AnimationClip *clip = NULL, bool useSimd = true, double spacing = 3.0)
+    {
+        std::vector<Human>(count).swap(humans);
+
+        // Modeller kameranın önünden geriye doğru kare bir
+        // ızgaraya yerleştirilir.
+        int columns = (int)std::ceil(std::sqrt((double)count));
+        for (int i = 0; i < count; i++)
+        {
+            Human &human = humans[i];
+            human.init(rig);
+
+            int row = i / columns, column = i % columns;
+            Coordinates place = {(column - (columns - 1) / 2.0) * spacing, -0.07, -row * spacing};
+            human.setMainCoordinates(place.x, place.y, place.z);
+            human.setRoamingCircle(place, spacing * CROWD_ROAM_RADIUS);
+
+            // Yön ve faz, modeller birbirinin aynısı görünmesin diye
+            // sıraya göre dağıtılır. (Her çalıştırmada aynı sahne)
+            human.setHeading((i * 37) % 360);
+            human.setPhase((i * 0.618034) - std::floor(i * 0.618034));
+            if (clip && !clip->isEmpty())
+                human.playClip(clip);
+            else
+            {
+                human.startWalking();
+                human.startWaving();
+            }
+        }
+
+        parts.clear();
+        if (count == 0)
+            return;
+
+        // Tüm modellerin iskeleti aynı olduğu için ilk modelinki
+        // kullanılır.
+        Skeleton &skeleton = humans[0].getSkeleton();
+        this->useSimd = useSimd;
+        collectParts();
+        actorVisible.assign(count, false);
+
+        // Başlangıç pozunun kapsama küresi, kollar ve bacaklar
+        // sallanırken dışarı taşmasın diye genişletilir.
+        humans[0].evaluate();
+        actorRadius = skeleton.getSubtreeRadius(0) * 1.5;
+
+        // Izgaranın hücresi bir modelin küresini alacak boydadır; ilk
+        // adımda tüm modeller bildirilir.
+        grid.init(2 * (actorRadius + CROWD_GRID_SLACK));
+        visibleActors.clear();
+        Coordinates unknown = {1e30, 1e30, 1e30};
+        gridCenters.assign(count, unknown);
+    }
+    void collectParts(void)
+    {
+        Skeleton &skeleton = humans[0].getSkeleton();
+        parts.clear();
+        partNodes.clear();
+        for (int node = 0; node < skeleton.size(); node++)
+            if (!skeleton.getNode(node)->isMerged())
+            {
+                parts.push_back(skeleton.getNode(node));
+                partNodes.push_back(node);
+            }
+        instances.clear();
+        lodLevels.assign(parts.size() * humans.size(), 0);
+    }
+    void setRigidMerging(bool enabled)
+    {
+        // Modellerin sabit alt ağaçları birleşik mesh'lerle mi çizilir
+        // (init'ten sonra, buildBatch'ten önce; tek mesh'li çizimde
+        // kapalı olmalı)
+        if (humans.empty())
+            return;
+        for (size_t h = 0; h < humans.size(); h++)
+            humans[h].setRigidMerging(enabled);
+        collectParts();
+    }
+
+    int size(void)
+    {
+        return humans.size();
+    }
+    void setSkinned(bool skinned)
+    {
+        // Parça parça örnekli çizim yerine tek mesh'li çizim (init'ten sonra)
+        this->skinned = skinned;
+        actorLevels.assign(humans.size(), 0);
+        actorSlots.assign(humans.size(), -1);
+    }
+    void setImpostors(const ImpostorAtlas *atlas, double pixelHeight)
+    {
+        // atlas NULL değilse ekranda pixelHeight'tan kısa görünen
+        // modeller impostor ile çizilir (init'ten sonra)
+        this->atlas = atlas;
+        impostorHeight = pixelHeight;
+        actorNear.assign(humans.size(), false);
+    }
+    void startRoaming(void)
+    {
+        // Tüm modeller yerlerinin çevresinde dolaşmaya başlar
+        for (size_t h = 0; h < humans.size(); h++)
+            humans[h].startRoaming();
+    }
+    void toggleWalking(void)
+    {
+        // Tek modeldeki sağ tık gibi: yürüme, dolaşma, duruş (simülasyon
+        // tarafında)
+        for (size_t h = 0; h < humans.size(); h++)
+            humans[h].toggleWalking();
+    }
+    void toggleWaving(int actor)
+    {
+        if (actor >= 0 && actor < (int)humans.size())
+            humans[actor].toggleWaving();
+    }
+    int pick(Coordinates origin, Coordinates direction, double maxDistance)
+    {
+        // Işının ilk değdiği model, yoksa -1 (çizim tarafında, update ile
+        // aynı iş parçacığından). Izgaradan kapsama küresine değenler
+        // sırayla bulunur ve ışın son çizilen pozdaki parçaların
+        // kürelerine karşı denenir.
+        if (!pickBatch)
+            return -1;
+        double length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        if (length == 0)
+            return -1;
+        Coordinates d = {direction.x / length, direction.y / length, direction.z / length};
+        Skeleton &skeleton = humans[0].getSkeleton();
+        return grid.raycast(origin, direction, maxDistance, [&](int h, double) -> double {
+            double nearest = -1;
+            for (int node = 0; node < skeleton.size(); node++)
+            {
+                // Birleşik mesh'teki cisimler kökünün küresindedir
+                if (skeleton.getNode(node)->isMerged())
+                    continue;
+                Coordinates center = pickBatch->getPosition(h, node);
+                double radius = skeleton.getNode(node)->getBoundingRadius();
+                double mx = origin.x - center.x, my = origin.y - center.y, mz = origin.z - center.z;
+                double b = mx * d.x + my * d.y + mz * d.z;
+                double c = mx * mx + my * my + mz * mz - radius * radius;
+                double discriminant = b * b - c;
+                if ((c > 0 && b > 0) || discriminant < 0)
+                    continue;
+                double distance = std::max(-b - std::sqrt(discriminant), 0.0);
+                if (nearest < 0 || distance < nearest)
+                    nearest = distance;
+            }
+            return nearest;
+        });
+    }
+
+    void buildBatch(SkeletonBatch &batch)
+    {
+        // Modellerin pozlarının yazılacağı toplu dizileri kurar
+        if (humans.empty())
+            return;
+        batch.build(humans[0].getSkeleton(), humans.size());
+        batch.useSimd = useSimd;
+    }
+
+    void animate(double time, SkeletonBatch &batch, std::vector<GLfloat> &phases, std::vector<ActorMove> &moves)
+    {
+        // Animasyonlar eklem açılarını verilen ana göre günceller,
+        // açılar toplu diziye kopyalanır ve tüm iskeletler birlikte
+        // hesaplanır. Modeller birbirinden bağımsız olduğu için
+        // işçilere dağıtılır. phases'e her modelin yürüme ve el
+        // sallama fazı ve katmanlarının ağırlığı yazılır (impostor seçimi
+        // için), moves'a ızgaradaki kaydından uzaklaşan modeller eklenir.
+        phases.resize(humans.size() * PHASE_FLOATS);
+        workers.parallelFor(humans.size(), CROWD_GRAIN, [this, time, &batch, &phases](int first, int last) {
+            for (int h = first; h < last; h++)
+            {
+                humans[h].animate(time);
+                batch.setRoot(h, humans[h].getRootMatrix());
+                batch.copyPose(h, humans[h].getSkeleton());
+                double walking, waving, walkingWeight, wavingWeight;
+                humans[h].getCyclePhases(walking, waving);
+                humans[h].getCycleWeights(walkingWeight, wavingWeight);
+                GLfloat *phase = &phases[h * PHASE_FLOATS];
+                phase[0] = walking;
+                phase[1] = waving;
+                phase[2] = walkingWeight;
+                phase[3] = wavingWeight;
+            }
+        });
+        batch.evaluate();
+
+        size_t reported = moves.size();
+        workers.parallelFor(humans.size(), CROWD_GRAIN, [this, &batch, &moves](int first, int last) {
+            std::vector<ActorMove> found;
+            for (int h = first; h < last; h++)
+            {
+                Coordinates center = batch.getPosition(h, 0);
+                double dx = center.x - gridCenters[h].x, dy = center.y - gridCenters[h].y, dz = center.z - gridCenters[h].z;
+                if (dx * dx + dy * dy + dz * dz <= CROWD_GRID_SLACK * CROWD_GRID_SLACK)
+                    continue;
+                gridCenters[h] = center;
+                ActorMove move = {h, center};
+                found.push_back(move);
+            }
+            if (found.empty())
+                return;
+            std::lock_guard<std::mutex> guard(movesLock);
+            moves.insert(moves.end(), found.begin(), found.end());
+        });
+
+        // Bildirimlerin sırası işçilerin bitiş sırasına bağlı olmasın diye
+        std::sort(moves.begin() + reported, moves.end(), [](const ActorMove &a, const ActorMove &b) {
+            return a.actor < b.actor;
+        });
+    }
+    void update(SkeletonBatch &batch, const std::vector<GLfloat> &phases, const std::vector<ActorMove> &moves, Coordinates eye, double pixelScale, const Frustum &frustum)
+    {
+        // Hesaplanmış iskeletlerden çizim örnekleri hazırlanır
+        // (animate'in doldurduğu toplu diziler ve bildirimlerle çağrılmalı)
+        pickBatch = &batch;
+
+        // Yer değiştiren modellerin ızgaradaki kaydı güncellenir
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            if (grid.contains(moves[i].actor))
+                grid.move(moves[i].actor, moves[i].center);
+            else
+                grid.insert(moves[i].actor, moves[i].center, actorRadius + CROWD_GRID_SLACK);
+        }
+
+        // Görüş alanının dışındaki modellerin hiçbir parçası çizilmez.
+        // Görünenler ızgaradan bulunur ve örnekler her çalıştırmada aynı
+        // sırada yazılsın diye sıralanır; önceki karede görünenlerin
+        // işareti silinir.
+        for (size_t i = 0; i < visibleActors.size(); i++)
+            actorVisible[visibleActors[i]] = false;
+        grid.queryFrustum(frustum, visibleActors);
+        std::sort(visibleActors.begin(), visibleActors.end());
+        for (size_t i = 0; i < visibleActors.size(); i++)
+            actorVisible[visibleActors[i]] = true;
+        impostors.clear();
+        impostorActors.clear();
+        if (atlas && atlas->isReady())
+            selectImpostors(batch, phases, eye, pixelScale);
+        else
+            drawnActors.assign(visibleActors.begin(), visibleActors.end());
+        if (skinned)
+        {
+            updateSkinned(batch, eye, pixelScale);
+            return;
+        }
+
+        // Her parça için modeller ayrıntı seviyelerine göre gruplanır:
+        // önce her modelin seviyesi seçilip sayılır, sonra örnekler
+        // seviyelerinin bölgesine yazılır. İki adım da (parça, çizilen
+        // modellerin grubu) işleri olarak dağıtılır; grupların bölgedeki
+        // yeri aradaki seri toplamla bulunduğu için sıra tek iş
+        // parçacığıyla aynıdır.
+        int parts = this->parts.size();
+        int groups = ((int)drawnActors.size() + CROWD_GRAIN - 1) / CROWD_GRAIN;
+        groupCounts.assign(parts * groups * LOD_LEVELS, 0);
+        workers.parallelFor(parts * groups, 1, [&](int first, int last) {
+            for (int job = first; job < last; job++)
+                selectLevels(batch, job / groups, job % groups, eye, pixelScale, frustum);
+        });
+
+        // groupCounts, her grubun her seviyedeki ilk örneğinin yerine
+        // çevrilir; örnekler yalnızca çizilenler kadar yer tutar.
+        batches.clear();
+        int next = 0;
+        for (int part = 0; part < parts; part++)
+            for (int level = 0; level < LOD_LEVELS; level++)
+            {
+                InstanceBatch group = {this->parts[part]->getLodMesh(level), next, 0};
+                for (int g = 0; g < groups; g++)
+                {
+                    int &slot = groupCounts[(part * groups + g) * LOD_LEVELS + level];
+                    int size = slot;
+                    slot = next;
+                    next += size;
+                    group.count += size;
+                }
+                batches.push_back(group);
+            }
+        instances.resize((size_t)next * INSTANCE_FLOATS);
+
+        workers.parallelFor(parts * groups, 1, [&](int first, int last) {
+            for (int job = first; job < last; job++)
+                writeInstances(batch, job / groups, job % groups);
+        });
+    }
+
+private:
+    // (parça, model grubu) başına her seviyedeki örnek sayısı, sonra
+    // ilk örneğin instances'taki yeri
+    std::vector<int> groupCounts;
+
+    void selectImpostors(SkeletonBatch &batch, const std::vector<GLfloat> &phases, Coordinates eye, double pixelScale)
+    {
+        // Ekranda impostorHeight'tan kısa görünen modeller parçalarıyla
+        // çizilmez, dörtgenleri impostors'a yazılır. Göze farDistance'tan
+        // yakın olabilecekler ızgaradan bulunup (küreler CROWD_GRID_SLACK
+        // kadar geniş olduğu için kaçan olmaz) uzaklıkları denenir;
+        // görünenlerden yakın olmayanlar, yürüme ve el sallama
+        // katmanları geçişte değilse impostor'dur.
+        double radius = atlas->getRadius();
+        double farDistance = 2 * radius * pixelScale / impostorHeight;
+        grid.queryRadius(eye, farDistance, nearActors);
+        for (size_t i = 0; i < nearActors.size(); i++)
+        {
+            int h = nearActors[i];
+            if (!actorVisible[h])
+                continue;
+            Coordinates position = batch.getPosition(h, 0);
+            double dx = position.x - eye.x, dy = position.y - eye.y, dz = position.z - eye.z;
+            actorNear[h] = dx * dx + dy * dy + dz * dz <= farDistance * farDistance;
+        }
+        drawnActors.clear();
+        for (size_t i = 0; i < visibleActors.size(); i++)
+        {
+            int h = visibleActors[i];
+            bool baked = ImpostorAtlas::hasCell(phases[h * PHASE_FLOATS + 2], phases[h * PHASE_FLOATS + 3]);
+            (actorNear[h] || !baked ? drawnActors : impostorActors).push_back(h);
+        }
+        for (size_t i = 0; i < nearActors.size(); i++)
+            actorNear[nearActors[i]] = false;
+        impostors.resize(impostorActors.size() * IMPOSTOR_FLOATS);
+
+        // Kameranın modelin önüne göre açısı, göz doğrultusunun gövdenin
+        // yerel X ve Z eksenlerindeki bileşenlerinden bulunur.
+        workers.parallelFor(impostorActors.size(), CROWD_GRAIN, [&](int first, int last) {
+            for (int i = first; i < last; i++)
+            {
+                int h = impostorActors[i];
+                Matrix4 world = batch.getWorldMatrix(h, 0);
+                Coordinates position = batch.getPosition(h, 0);
+                double dx = eye.x - position.x, dy = eye.y - position.y, dz = eye.z - position.z;
+                double localX = world.m[0] * dx + world.m[1] * dy + world.m[2] * dz;
+                double localZ = world.m[8] * dx + world.m[9] * dy + world.m[10] * dz;
+                double viewAngle = std::atan2(localX, localZ) * 180 / PI;
+                const GLfloat *phase = &phases[h * PHASE_FLOATS];
+                int cell = atlas->cellAt(viewAngle, phase[0], phase[1], phase[2], phase[3]);
+
+                GLfloat *impostor = &impostors[i * IMPOSTOR_FLOATS];
+                impostor[0] = position.x;
+                impostor[1] = position.y;
+                impostor[2] = position.z;
+                impostor[3] = cell % IMPOSTOR_COLUMNS;
+                impostor[4] = cell / IMPOSTOR_COLUMNS;
+            }
+        });
+    }
+    void updateSkinned(SkeletonBatch &batch, Coordinates eye, double pixelScale)
+    {
+        // Çizilen her modelin seviyesi en büyük parçası (gövde) ile
+        // seçilir, modeller seviyelerine göre sıralanıp kemikleri
+        // bones'a yazılır.
+        int drawn = drawnActors.size(), nodes = humans[0].getSkeleton().size();
+        double radius = parts[0]->getBoundingRadius();
+        workers.parallelFor(drawn, CROWD_GRAIN, [&](int first, int last) {
+            for (int i = first; i < last; i++)
+            {
+                int h = drawnActors[i];
+                Coordinates position = batch.getPosition(h, 0);
+                double dx = position.x - eye.x, dy = position.y - eye.y, dz = position.z - eye.z;
+                double distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz), 1e-6);
+                actorLevels[h] = selectLodLevel(radius * pixelScale / distance, actorLevels[h]);
+            }
+        });
+
+        std::fill(levelCounts, levelCounts + LOD_LEVELS, 0);
+        for (int i = 0; i < drawn; i++)
+            levelCounts[actorLevels[drawnActors[i]]]++;
+        int next[LOD_LEVELS];
+        for (int level = 0, first = 0; level < LOD_LEVELS; first += levelCounts[level], level++)
+            next[level] = first;
+        for (int i = 0; i < drawn; i++)
+            actorSlots[drawnActors[i]] = next[actorLevels[drawnActors[i]]]++;
+
+        bones.resize((size_t)drawn * nodes * BONE_FLOATS);
+        workers.parallelFor(drawn, CROWD_GRAIN, [&](int first, int last) {
+            for (int i = first; i < last; i++)
+            {
+                int h = drawnActors[i];
+                for (int node = 0; node < nodes; node++)
+                    batch.writeBoneRows(h, node, &bones[((size_t)actorSlots[h] * nodes + node) * BONE_FLOATS]);
+            }
+        });
+    }
+
+    void selectLevels(SkeletonBatch &batch, int part, int group, Coordinates eye, double pixelScale, const Frustum &frustum)
+    {
+        int count = humans.size(), groups = ((int)drawnActors.size() + CROWD_GRAIN - 1) / CROWD_GRAIN;
+        Object *object = parts[part];
+        unsigned char *levels = &lodLevels[part * count];
+        int *counts = &groupCounts[(part * groups + group) * LOD_LEVELS];
+        for (int i = group * CROWD_GRAIN, last = std::min(i + CROWD_GRAIN, (int)drawnActors.size()); i < last; i++)
+        {
+            // Görünmeyen örnekler LOD_LEVELS ile işaretlenip atlanır.
+            int h = drawnActors[i];
+            Coordinates position = batch.getPosition(h, partNodes[part]);
+            if (!frustum.containsSphere(position, object->getBoundingRadius()))
+            {
+                levels[h] = (levels[h] % LOD_LEVELS) + LOD_LEVELS;
+                continue;
+            }
+
+            double dx = position.x - eye.x, dy = position.y - eye.y, dz = position.z - eye.z;
+            double distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz), 1e-6);
+            levels[h] = selectLodLevel(object->getLodRadius() * pixelScale / distance, levels[h] % LOD_LEVELS);
+            counts[levels[h]]++;
+        }
+    }
+    void writeInstances(SkeletonBatch &batch, int part, int group)
+    {
+        int count = humans.size(), groups = ((int)drawnActors.size() + CROWD_GRAIN - 1) / CROWD_GRAIN;
+        const unsigned char *levels = &lodLevels[part * count];
+        int next[LOD_LEVELS];
+        memcpy(next, &groupCounts[(part * groups + group) * LOD_LEVELS], sizeof(next));
+
+        RGBA color = parts[part]->getColor();
+        for (int i = group * CROWD_GRAIN, last = std::min(i + CROWD_GRAIN, (int)drawnActors.size()); i < last; i++)
+        {
+            int h = drawnActors[i];
+            if (levels[h] >= LOD_LEVELS)
+                continue;
+
+            GLfloat *instance = &instances[next[levels[h]]++ * INSTANCE_FLOATS];
+            batch.writeMeshMatrix(h, partNodes[part], instance);
+            instance[16] = color.red;
+            instance[17] = color.green;
+            instance[18] = color.blue;
+            instance[19] = color.alpha;
+        }
+    }
+};
+
+/////////////////////////////////////////////////////////////////// SİMÜLASYON
+
+/*
+Animasyonlar ve iskelet hesabı ayrı bir iş parçacığında sabit adımlarla
+yürür; çizim her karede simülasyonun yayımladığı en son pozu alır.
+İkisi arasında kilit yoktur: üç tamponlu (triple buffer) değişimde
+simülasyon hep kendi tamponuna yazar, bitirdiğinde onu ortadaki
+tamponla değiştirir; çizim de yeni bir kare varsa kendi tamponunu
+ortadakiyle değiştirir. Hiçbir taraf diğerini beklemez, çizim yarım
+yazılmış bir poz görmez ve yavaş bir kare simülasyonu yavaşlatmaz.
+
+Girdiler (klavye, fare) simülasyona olay olarak gönderilir ve bir
+sonraki adımın başında sırayla uygulanır. Penceresiz çizimde ve
+kıyaslamada iş parçacığı açılmaz; adım her karenin başında çizimle aynı
+iş parçacığında atılır, böylece kareler her çalıştırmada aynıdır.
+*/
+
+// Ortadaki tamponun yeni yayımlandığını (okurun henüz almadığını)
+// gösteren bit
+#define TRIPLE_BUFFER_FRESH 4
+
+template <typename T>
+class TripleBuffer
+{
+private:
+    T slots[3];
+
+    // Yazarın ve okurun tamponları ile aradaki tampon (ve
+    // TRIPLE_BUFFER_FRESH biti). back yalnızca yazar, front yalnızca
+    // okur tarafından kullanılır.
+    int back, front;
+    std::atomic<int> middle;
+
+public:
+    TripleBuffer(void)
+    {
+        back = 0;
+        front = 1;
+        middle = 2;
+    }
+    T &slot(int index)
+    {
+        // Tamponların kurulması için (iki taraf da çalışmıyorken)
+        return slots[index];
+    }
+
+    T &getWriteBuffer(void)
+    {
+        return slots[back];
+    }
+    bool publish(void)
+    {
+        // Yazılan tampon ortadakiyle değiştirilir. Bir önceki yayımlanan
+        // tamponu okur almışsa true döner.
+        int previous = middle.exchange(back | TRIPLE_BUFFER_FRESH);
+        back = previous & 3;
+        return !(previous & TRIPLE_BUFFER_FRESH);
+    }
+
+    bool acquire(void)
+    {
+        // Yeni yayımlanan bir tampon varsa okurun tamponuyla
+        // değiştirilir; yoksa okur son tamponunda kalır.
+        if (!(middle.load() & TRIPLE_BUFFER_FRESH))
+            return false;
+        front = middle.exchange(front) & 3;
+        return true;
+    }
+    T &getReadBuffer(void)
+    {
+        return slots[front];
+    }
+};
+
+// Simülasyonun bir adımının sonucu: tek model modunda eklem açıları
+// ve kökün konumu, kalabalık modunda tüm modellerin hesaplanmış
+// iskeletleri
+
+typedef struct frameSnapshot
+{
+    double time;
+    bool animating;
+
+    // Bu kareye kadar uygulanan girdi sayısı
+    unsigned int commands;
+
+    std::vector<Angles> joints;
+    Coordinates position;
+    Angles angle;
+
+    SkeletonBatch crowd;
+
+    // Kalabalıktaki her modelin yürüme ve el sallama fazı ve katman
+    // ağırlıkları (PHASE_FLOATS) ile ızgaradaki kaydı güncellenecek
+    // modeller (okurun almadığı önceki karelerin bildirdikleri dahil,
+    // bildiriliş sırasıyla)
+    std::vector<GLfloat> crowdPhases;
+    std::vector<ActorMove> crowdMoves;
+} FrameSnapshot;
+
+// Simülasyona gönderilen girdiler. code klavyede tuş, farede düğme,
+// özel tuşlarda (oklar) GLUT_KEY_* değeri, seçimde (kalabalıkta sol tık)
+// modelin sırasıdır; tick olayın uygulandığı simülasyon adımıdır. Özel
+// tuşlar kamerayı çizim tarafında hareket ettirir, simülasyona yalnızca
+// oturum kaydına yazılmak için gelir.
+
+#define INPUT_KEY 0
+#define INPUT_MOUSE 1
+#define INPUT_SPECIAL 2
+#define INPUT_PICK 3
+
+typedef struct inputEvent
+{
+    int type;
+    int code;
+    long long tick;
+} InputEvent;
+
+/*
+SessionLog, bir oturumun girdilerini ve simülasyon adımlarını ikili bir
+dosyaya yazar (--record) veya tekrar oynatmak için okur (--replay).
+Dosya, başlıktan sonra sırayla yazılan kayıtlardır:
+
+    adım  : SESSION_STEP (1 bayt), an (double), pozun özeti (uint64)
+    girdi : girdinin tipi + 1 (1 bayt), kodu (1 bayt; seçimde int32)
+
+Bir girdi, kendisinden sonraki ilk adımın başında uygulanmıştır. Anlar
+simülasyon saatinin değerleridir; animasyonlar yalnızca ana ve girdilere
+bağlı olduğu için aynı anlarda aynı girdilerle atılan adımlar aynı
+pozları verir. Özet, tekrarda pozların bit bit aynı olduğunu doğrular.
+
+Seçim girdisi (INPUT_PICK) 2. sürümde eklendi; 1. sürüm dosyalarında
+yalnızca bir baytlık kodlu girdiler bulunduğu için onlar da okunur.
+*/
+
+#define SESSION_VERSION 2
+#define SESSION_OLDEST_VERSION 1
+#define SESSION_STEP 0
+
+typedef struct sessionHeader
+{
+    char magic[4]; // "BSMS"
+    uint32_t version;
+    uint32_t crowdSize; // kaydedilen sahnenin model sayısı (0: tek model)
+    uint32_t animate;   // sahne animasyonlar açık başladıysa 1
+} SessionHeader;
+
+typedef struct sessionStep
+{
+    double time;
+    uint64_t hash;
+
+    // Adımın başında uygulanan girdiler (SessionLog::getInput)
+    int firstInput, inputCount;
+} SessionStep;
+
+class SessionLog
+{
+private:
+    std::ofstream output;
+    SessionHeader header;
+    std::vector<SessionStep> steps;
+    std::vector<InputEvent> inputs;
+
+public:
+    SessionLog(void)
+    {
+        memset(&header, 0, sizeof(header));
+    }
+
+    bool create(const std::string &path, int crowdSize, bool animate)
+    {
+        memcpy(header.magic, "BSMS", 4);
+        header.version = SESSION_VERSION;
+        header.crowdSize = crowdSize;
+        header.animate = animate;
+        output.open(path.c_str(), std::ios::binary);
+        output.write((const char *)&header, sizeof(header));
+        if (!output)
+        {
+            std::cerr << "oturum kaydı açılamadı: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+    void writeInput(const InputEvent &event)
+    {
+        unsigned char kind = event.type + 1;
+        output.write((const char *)&kind, 1);
+        if (event.type == INPUT_PICK)
+        {
+            int32_t actor = event.code;
+            output.write((const char *)&actor, sizeof(actor));
+        }
+        else
+        {
+            unsigned char code = event.code;
+            output.write((const char *)&code, 1);
+        }
+    }
+    void writeStep(double time, uint64_t hash)
+    {
+        char kind = SESSION_STEP;
+        output.write(&kind, 1);
+        output.write((const char *)&time, sizeof(time));
+        output.write((const char *)&hash, sizeof(hash));
+    }
+    void close(void)
+    {
+        if (output.is_open())
+            output.close();
+    }
+
+    bool load(const std::string &path)
+    {
+        // Tüm dosya okunur; son adımdan sonra kalan girdiler (kayıt
+        // adımları yazılmadan kesildiyse) atılır.
+        steps.clear();
+        inputs.clear();
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "oturum kaydı açılamadı: " << path << std::endl;
+            return false;
+        }
+        std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const char *data = contents.empty() ? NULL : &contents[0];
+        size_t size = contents.size();
+        if (size < sizeof(SessionHeader) ||
+            memcmp(data, "BSMS", 4) != 0 ||
+            ((const SessionHeader *)data)->version < SESSION_OLDEST_VERSION ||
+            ((const SessionHeader *)data)->version > SESSION_VERSION)
+        {
+            std::cerr << "geçersiz oturum kaydı: " << path << std::endl;
+            return false;
+        }
+        memcpy(&header, data, sizeof(header));
+
+        size_t position = sizeof(SessionHeader);
+        int firstInput = 0;
+        while (position < size)
+        {
+            unsigned char kind = data[position];
+            if (kind == SESSION_STEP && position + 17 <= size)
+            {
+                SessionStep step;
+                memcpy(&step.time, data + position + 1, sizeof(step.time));
+                memcpy(&step.hash, data + position + 9, sizeof(step.hash));
+                step.firstInput = firstInput;
+                step.inputCount = inputs.size() - firstInput;
+                steps.push_back(step);
+                firstInput = inputs.size();
+                position += 17;
+            }
+            else if (kind >= INPUT_KEY + 1 && kind <= INPUT_SPECIAL + 1 && position + 2 <= size)
+            {
+                InputEvent event = {kind - 1, (unsigned char)data[position + 1], -1};
+                inputs.push_back(event);
+                position += 2;
+            }
+            else if (kind == INPUT_PICK + 1 && position + 5 <= size)
+            {
+                int32_t actor;
+                memcpy(&actor, data + position + 1, sizeof(actor));
+                InputEvent event = {INPUT_PICK, actor, -1};
+                inputs.push_back(event);
+                position += 5;
+            }
+            else
+                break;
+        }
+        inputs.resize(firstInput);
+        if (steps.empty())
+        {
+            std::cerr << "oturum kaydında adım yok: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+    const SessionHeader &getHeader(void) const
+    {
+        return header;
+    }
+    int stepCount(void) const
+    {
+        return steps.size();
+    }
+    const SessionStep &getStep(int index) const
+    {
+        return steps[index];
+    }
+    const InputEvent &getInput(int index) const
+    {
+        return inputs[index];
+    }
+};
+
+class Simulation
+{
+private:
+    // Animasyonları ilerleten saat ve simülasyon tarafındaki modeller
+    // (çizimdeki model yalnızca yayımlanan pozu kopyalar)
+    SimulationClock clock;
+    Human model;
+    Crowd *crowd;
+    const AnimationClip *clip;
+
+    TripleBuffer<FrameSnapshot> frames;
+
+    // Okurun henüz almadığı karelerde bildirilen yer değiştirmeler;
+    // bir sonraki kareye de yazılırlar.
+    std::vector<ActorMove> unseenMoves;
+
+    // Bekleyen girdiler; posted çizim, applied simülasyon tarafında sayılır
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque<InputEvent> pending;
+    unsigned int posted, applied;
+
+    std::thread thread;
+    bool threaded, stopping;
+
+    // Penceresiz çizimde saat duvar saatinden bağımsız, her adımda
+    // stepInterval kadar ilerler.
+    bool headless;
+    double stepInterval;
+    bool animating;
+
+    // Oturum kaydı (--record) ve tekrar oynatılan kayıt (--replay).
+    // Tekrarda adımların anları kayıttan alınır ve her adımın pozu
+    // kayıttakiyle karşılaştırılır.
+    SessionLog recorder, replay;
+    bool recording, replaying;
+    int replayCursor, replayMismatches;
+
+    unsigned long long hashFrame(const FrameSnapshot &frame)
+    {
+        if (crowd)
+            return frame.crowd.hashPose(HASH_SEED);
+        unsigned long long hash = hashBytes(HASH_SEED, &frame.joints[0], frame.joints.size() * sizeof(Angles));
+        hash = hashBytes(hash, &frame.position, sizeof(frame.position));
+        return hashBytes(hash, &frame.angle, sizeof(frame.angle));
+    }
+
+    void applyInput(const InputEvent &event)
+    {
+        if (event.type == INPUT_SPECIAL)
+            return;
+
+        // Kalabalıkta seçilen model el sallamayı, sağ tık tüm modellerin
+        // yürüme/dolaşma/duruşunu değiştirir
+        if (event.type == INPUT_PICK)
+        {
+            if (crowd)
+                crowd->toggleWaving(event.code);
+            return;
+        }
+        if (event.type == INPUT_MOUSE && crowd && event.code == GLUT_RIGHT_BUTTON)
+        {
+            crowd->toggleWalking();
+            return;
+        }
+        if (event.type == INPUT_MOUSE)
+        {
+            switch (event.code)
+            {
+            case GLUT_LEFT_BUTTON:
+                model.toggleWaving(); // wave
+                break;
+            case GLUT_RIGHT_BUTTON:
+                model.toggleWalking(); // walk
+                break;
+            }
+            return;
+        }
+
+        switch (event.code)
+        {
+        case 'q':
+            model.raiseAngle(LEFT_FOREARM, Z, -1);
+            break;
+        case 'Q':
+            model.raiseAngle(LEFT_FOREARM, Z, 1);
+            break;
+        case 'w':
+            model.raiseAngle(LEFT_ARM, Z, -1);
+            break;
+        case 'W':
+            model.raiseAngle(LEFT_ARM, Z, 1);
+            break;
+
+        case 't':
+            model.raiseAngle(RIGHT_FOREARM, Z, 1);
+            break;
+        case 'T':
+            model.raiseAngle(RIGHT_FOREARM, Z, -1);
+            break;
+        case 'r':
+            model.raiseAngle(RIGHT_ARM, Z, 1);
+            break;
+        case 'R':
+            model.raiseAngle(RIGHT_ARM, Z, -1);
+            break;
+
+        case 'e':
+        case 'E':
+            model.raiseMainCoordinates(0, 0, 0.1);
+            break;
+        case 'd':
+        case 'D':
+            model.raiseMainCoordinates(0, 0, -0.1);
+            break;
+        case 's':
+        case 'S':
+            model.raiseMainCoordinates(0.1, 0, 0);
+            break;
+        case 'f':
+        case 'F':
+            model.raiseMainCoordinates(-0.1, 0, 0);
+            break;
+
+        case 'a':
+            model.raiseAngle(RIGHT_FOOT, X, -1);
+            break;
+        case 'A':
+            model.raiseAngle(RIGHT_FOOT, X, 1);
+            break;
+
+        case 'c':
+        case 'C':
+            // Yüklenen klibi oynat/durdur
+            model.toggleClip(clip);
+            break;
+        }
+    }
+
+    void run(void)
+    {
+        // Animasyon sürerken her stepInterval'da bir adım atılır;
+        // sürmüyorsa bir sonraki girdiye kadar beklenir.
+        std::chrono::steady_clock::duration interval =
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(stepInterval));
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> guard(lock);
+        while (!stopping)
+        {
+            guard.unlock();
+            step();
+            guard.lock();
+
+            next = std::max(next + interval, std::chrono::steady_clock::now());
+            if (animating)
+                wake.wait_until(guard, next, [this] { return stopping || !pending.empty(); });
+            else
+                wake.wait(guard, [this] { return stopping || !pending.empty(); });
+        }
+    }
+
+public:
+    Simulation(void)
+    {
+        crowd = NULL;
+        clip = NULL;
+        posted = applied = 0;
+        threaded = stopping = false;
+        headless = false;
+        stepInterval = 1.0 / SIMULATION_RATE;
+        animating = false;
+        recording = replaying = false;
+        replayCursor = replayMismatches = 0;
+    }
+    ~Simulation(void)
+    {
+        stop();
+        recorder.close();
+    }
+
+    void init(const Rig &rig, const AnimationClip *clip, Crowd *crowd, bool animate, double startTime)
+    {
+        // crowd NULL değilse tek model yerine kalabalık canlandırılır
+        this->clip = clip;
+        this->crowd = crowd;
+
+        model.init(rig);
+        if (animate && clip && !clip->isEmpty())
+            model.playClip(clip);
+        else if (animate)
+        {
+            model.startWalking();
+            model.startWaving();
+        }
+
+        for (int i = 0; i < 3; i++)
+        {
+            FrameSnapshot &frame = frames.slot(i);
+            frame.time = 0;
+            frame.animating = false;
+            frame.commands = 0;
+            frame.crowdMoves.clear();
+            frame.joints.assign(model.jointCount(), Angles());
+            frame.position = model.getMainCoordinates();
+            frame.angle = model.getMainAngle();
+            if (crowd)
+                crowd->buildBatch(frame.crowd);
+        }
+
+        unseenMoves.clear();
+
+        // Simülasyon istenen andan başlar (kalabalık modunda anlamlı)
+        clock.seek(startTime);
+    }
+    bool record(const std::string &path, bool animate)
+    {
+        // Bundan sonraki girdiler ve adımlar dosyaya yazılır (init'ten
+        // sonra, start'tan önce)
+        recording = recorder.create(path, crowd ? crowd->size() : 0, animate);
+        return recording;
+    }
+    bool startReplay(const std::string &path, bool animate)
+    {
+        // Adımlar kayıttaki anlarda ve yalnızca replayStep ile atılır
+        // (init'ten sonra, start'tan önce; iş parçacığı açılmamalı).
+        // Başka bir sahnede alınmış kayıt oynatılmaz: pozlar zaten
+        // farklı çıkacağı için karşılaştırmanın bir anlamı olmaz.
+        replaying = false;
+        replayCursor = replayMismatches = 0;
+        if (!replay.load(path))
+            return false;
+        const SessionHeader &header = replay.getHeader();
+        if ((int)header.crowdSize != (crowd ? crowd->size() : 0) || (header.animate != 0) != animate)
+        {
+            std::cerr << "oturum kaydı başka bir sahnede alınmış, aynı seçeneklerle oynatılmalı (--crowd="
+                      << header.crowdSize << (header.animate ? " --animate" : "") << ")" << std::endl;
+            return false;
+        }
+        replaying = true;
+        return true;
+    }
+    void start(double stepInterval, bool headless, bool threaded)
+    {
+        // threaded değilse adımlar update ile çizimden atılır
+        this->stepInterval = stepInterval;
+        this->headless = headless;
+        this->threaded = threaded;
+        if (!threaded)
+            return;
+
+        // İlk kare çizim başlamadan hazır olsun diye ilk adım burada
+        step();
+        frames.acquire();
+        stopping = false;
+        thread = std::thread(&Simulation::run, this);
+    }
+    void stop(void)
+    {
+        if (!thread.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+
+    void step(void)
+    {
+        // Bekleyen girdiler simülasyonun şimdiki anında uygulanır
+        // (animasyonlar girdi anından başlasın/dursun diye model önce
+        // o ana getirilir), sonra poz hesaplanıp yayımlanır.
+        std::deque<InputEvent> events;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            events.swap(pending);
+        }
+
+        if (!headless && !replaying)
+            clock.advance();
+        double time = replaying ? replay.getStep(replayCursor).time : clock.getTime();
+        if (!events.empty())
+        {
+            model.animate(time);
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                events[i].tick = clock.getTicks();
+                applyInput(events[i]);
+                if (recording)
+                    recorder.writeInput(events[i]);
+            }
+            applied += events.size();
+        }
+
+        FrameSnapshot &frame = frames.getWriteBuffer();
+        frame.time = time;
+        std::vector<ActorMove> stepMoves;
+        if (crowd)
+        {
+            frame.crowdMoves = unseenMoves;
+            crowd->animate(time, frame.crowd, frame.crowdPhases, frame.crowdMoves);
+            stepMoves.assign(frame.crowdMoves.begin() + unseenMoves.size(), frame.crowdMoves.end());
+        }
+        else
+        {
+            model.animate(time);
+            model.getJointAngles(&frame.joints[0]);
+            frame.position = model.getMainCoordinates();
+            frame.angle = model.getMainAngle();
+        }
+        animating = crowd != NULL || model.isAnimating();
+        frame.animating = animating;
+        frame.commands = applied;
+
+        if (recording || replaying)
+        {
+            unsigned long long hash = hashFrame(frame);
+            if (recording)
+                recorder.writeStep(time, hash);
+            if (replaying && hash != replay.getStep(replayCursor++).hash)
+                replayMismatches++;
+        }
+
+        // Okur önceki kareyi aldıysa onun bildirimlerini görmüştür;
+        // almadıysa bu karenin bildirimleri de bir sonrakine taşınır.
+        if (frames.publish())
+            unseenMoves.swap(stepMoves);
+        else
+            unseenMoves.insert(unseenMoves.end(), stepMoves.begin(), stepMoves.end());
+
+        if (headless)
+            clock.advance(stepInterval);
+    }
+
+    void post(int type, int code)
+    {
+        // Girdiyi bir sonraki adımda uygulanmak üzere kuyruğa ekler
+        // (çizim tarafından çağrılır)
+        InputEvent event = {type, code, -1};
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            pending.push_back(event);
+        }
+        posted++;
+        wake.notify_one();
+    }
+    FrameSnapshot &update(void)
+    {
+        // Çizilecek kare: iş parçacığı yoksa adım şimdi atılır, varsa
+        // yayımlanan en son kare alınır. (Tekrarda adımlar replayStep
+        // ile atılır.)
+        if (!threaded && !replaying)
+            step();
+        frames.acquire();
+        return frames.getReadBuffer();
     }
-    void raiseMainCoordinates(double x, double y, double z)
+    bool isAnimating(void)
     {
-        // Modelin koordinatlarını düzenler
-        mainPosition.x += x;
-        mainPosition.y += y;
-        mainPosition.z += z;
+        // Son alınan kare hareketliyse, henüz uygulanmamış girdi veya
+        // oynatılmamış kayıt varsa yeni kareler çizilmelidir.
+        const FrameSnapshot &frame = frames.getReadBuffer();
+        return frame.animating || posted != frame.commands || (replaying && !isReplayFinished());
     }
 
-    void raiseAngle(int partNumber, int direction, double angle)
+    bool isReplaying(void)
     {
-        // Bu metod spesifik bir vücut parçası için ilgili ekleminin
-        // dönüş değerlerini artırıp azaltıyor.
-        switch (partNumber)
-        {
-        case LEFT_ARM:
-            if (direction == X)
-                leftShoulder.jointAngles[0].x += angle;
-            else if (direction == Y)
-                leftShoulder.jointAngles[0].y += angle;
-            else if (direction == Z)
-                leftShoulder.jointAngles[0].z += angle;
-            break;
-        case LEFT_FOREARM:
-            if (direction == X)
-                leftElbow.jointAngles[0].x += angle;
-            else if (direction == Y)
-                leftElbow.jointAngles[0].y += angle;
-            else if (direction == Z)
-                leftElbow.jointAngles[0].z += angle;
-            break;
-        case RIGHT_ARM:
-            if (direction == X)
-                rightShoulder.jointAngles[0].x += angle;
-            else if (direction == Y)
-                rightShoulder.jointAngles[0].y += angle;
-            else if (direction == Z)
-                rightShoulder.jointAngles[0].z += angle;
-            break;
-        case RIGHT_FOREARM:
-            if (direction == X)
-                rightElbow.jointAngles[0].x += angle;
-            else if (direction == Y)
-                rightElbow.jointAngles[0].y += angle;
-            else if (direction == Z)
-                rightElbow.jointAngles[0].z += angle;
-            break;
-        case RIGHT_FOOT:
-            if (direction == X)
-                rightHip.jointAngles[0].x += angle;
-            else if (direction == Y)
-                rightHip.jointAngles[0].y += angle;
-            else if (direction == Z)
-                rightHip.jointAngles[0].z += angle;
-            break;
-        case LEFT_FOOT:
-            if (direction == X)
-                leftHip.jointAngles[0].x += angle;
-            else if (direction == Y)
-                leftHip.jointAngles[0].y += angle;
-            else if (direction == Z)
-                leftHip.jointAngles[0].z += angle;
-            break;
-        }
+        return replaying;
     }
-    void setAngle(int partNumber, int direction, double angle)
+    bool isReplayFinished(void)
     {
-        // Bu metod spesifik bir vücut parçası için ilgili ekleminin
-        // dönüş değerlerini değiştiriyor.
-        switch (partNumber)
-        {
-        case LEFT_ARM:
-            if (direction == X)
-                leftShoulder.jointAngles[0].x = angle;
-            else if (direction == Y)
-                leftShoulder.jointAngles[0].y = angle;
-            else if (direction == Z)
-                leftShoulder.jointAngles[0].z = angle;
-            break;
-        case LEFT_FOREARM:
-            if (direction == X)
-                leftElbow.jointAngles[0].x = angle;
-            else if (direction == Y)
-                leftElbow.jointAngles[0].y = angle;
-            else if (direction == Z)
-                leftElbow.jointAngles[0].z = angle;
-            break;
-        case RIGHT_ARM:
-            if (direction == X)
-                rightShoulder.jointAngles[0].x = angle;
-            else if (direction == Y)
-                rightShoulder.jointAngles[0].y = angle;
-            else if (direction == Z)
-                rightShoulder.jointAngles[0].z = angle;
-            break;
-        case RIGHT_FOREARM:
-            if (direction == X)
-                rightElbow.jointAngles[0].x = angle;
-            else if (direction == Y)
-                rightElbow.jointAngles[0].y = angle;
-            else if (direction == Z)
-                rightElbow.jointAngles[0].z = angle;
-            break;
-        case RIGHT_FOOT:
-            if (direction == X)
-                rightHip.jointAngles[0].x += angle;
-            else if (direction == Y)
-                rightHip.jointAngles[0].y += angle;
-            else if (direction == Z)
-                rightHip.jointAngles[0].z += angle;
-            break;
-        case LEFT_FOOT:
-            if (direction == X)
-                leftHip.jointAngles[0].x += angle;
-            else if (direction == Y)
-                leftHip.jointAngles[0].y += angle;
-            else if (direction == Z)
-                leftHip.jointAngles[0].z += angle;
-            break;
-        }
+        return replayCursor >= replay.stepCount();
     }
-
-    void startWalking(unsigned int a = 128)
+    const SessionStep &nextReplayStep(void)
     {
-        walkingTotalAnimationIteration = a;
-        walking = true;
+        return replay.getStep(replayCursor);
     }
-    void stopWalking(void)
+    const InputEvent &getReplayInput(int index)
     {
-        walking = false;
+        return replay.getInput(index);
     }
-    void toggleWalking(void)
+    void replayStep(void)
     {
-        // ilk tıkta yürüme animasyonu başlatıyor,
-        // ikinci tıkta dolaşma animasyonu da başlatıyor,
-        // üçüncü tıkta ikisi de kapatılıyor
-        if (walking)
-        {
-            if (roaming)
-            {
-                stopWalking();
-                toggleRoaming();
-            }
-            else
-                startRoaming();
-        }
-        else
-            startWalking();
+        // Kayıttaki sıradaki adım (girdileri post ile verilmiş olmalı)
+        if (replaying && !isReplayFinished())
+            step();
     }
-    void walkAnimation(void)
+    void endReplay(void)
     {
-        if (!walking)
+        // Biten tekrardan sonra simülasyon kaydın son anından canlı
+        // sürer: adımlar yine update ile atılır, girdiler kabul edilir.
+        // (Penceresiz çizimde tekrar bitince çizim de biter.)
+        if (!replaying || !isReplayFinished())
             return;
+        if (replay.stepCount() > 0)
+            clock.seek(replay.getStep(replay.stepCount() - 1).time);
+        replaying = false;
+    }
+    int getReplayLength(void)
+    {
+        return replay.stepCount();
+    }
+    int getReplayMismatches(void)
+    {
+        return replayMismatches;
+    }
+};
 
-        // Animasyonun her karesi için animasyonun tamamlanma yüzdesi
-        // cosinus fonksiyonundan geçirilerek animasyon lineer değil sinusoidal
-        // hale getiriliyor (ease-in-out)
+/////////////////////////////////////////////////////////////////// SABİT SAHNE
 
-        // frameAngleX -2 ile 2 arasında değerler üretiyor. (tamamlanma yüzdesine göre)
-        // framePositionY -0.07 ile -0.08 arasında değerler üretiyor.
+/*
+Sahnedeki hareket etmeyen cisimler (kutular, zemin, ileride eklenecek
+diğer dekorlar) başlangıçta bir kez kaydedilir. Mesh'i olan cisimlerin
+köşeleri model matrisiyle dünya koordinatlarına taşınır ve aynı renkte
+olanlar tek bir mesh'te birleştirilir; her karede renk başına tek
+glDrawElements yapılır, matris yığınına dokunulmaz. Toplu mesh'ler ilk
+çizildiklerinde (veya yeni cisim eklendikten sonra) vertex/index
+tamponlarına (VBO) yüklenir; sonraki karelerde köşeler yeniden
+gönderilmez.
+
+Üçgenleri elimizde olmayan şekiller (glutSolidTeapot gibi) birer
+display list'e derlenir ve tek glCallList ile çizilir.
+
+Normaller, sabit işlevli OpenGL'in yaptığı gibi matrisin 3x3 kısmının
+ters devriğiyle dönüştürülür ve birim yapılmaz (GL_NORMALIZE kapalı);
+böylece glScaled ile çizilen bir cisim birleştirildikten sonra da aynı
+aydınlanır.
+
+Her cismin kapsama küresi ayrıca bir SpatialGrid'e yazılır: görüş
+alanındaki cisimler ızgaradan bulunur ve cisimlerinden biri görünen
+toplu mesh'ler ile display list'ler çizilir.
+*/
 
-        double frameAngleX = 2 * std::cos(walkingCompletionPercent * 360 * PI / 180);
-        double framePositionY = 0.05 * std::cos(walkingCompletionPercent * 2 * 360 * PI / 180) - 0.075;
-        // bu fonksiyonun periyodu ilk fonksiyonun periyodunun yarısı kadar
+// Sabit sahne ızgarasının hücre boyu
+#define STATIC_GRID_CELL 4.0
 
-        // Sol ve sağ bacak frameAngleX'in zıt işaretlileriyle eğiliyor.
+typedef struct staticBatch
+{
+    RGBA color;
+    Mesh mesh;
+    GLuint vertexBuffer, indexBuffer;
+    bool uploaded; // tamponlar mesh'in son hâlini taşıyor mu
+} StaticBatch;
 
-        setAngle(RIGHT_FOOT, X, frameAngleX);
-        setAngle(LEFT_FOOT, X, -frameAngleX);
+typedef struct staticList
+{
+    RGBA color;
+    GLuint list;
+} StaticList;
 
-        // Modelin adım atma sırasında yükselip alçalması için;
+// Kaydedilen bir cismin çizildiği toplu mesh veya display list
+typedef struct staticProp
+{
+    bool list;
+    int index;
+} StaticProp;
 
-        mainPosition.y = framePositionY;
+class StaticScene
+{
+private:
+    std::vector<StaticBatch> batches;
+    std::vector<StaticList> lists;
 
-        // Animasyon çağrılırken belirtilen, animasyonun bir döngüsünün gerçekleşeceği
-        // toplam kare sayısının tersi alınarak tamamlanma yüzdesi arttırılıyor.
+    // Cisimler (ızgaradaki id'leri sıralarıdır) ve son karede görünen
+    // cisimlerin toplu mesh'leri ile display list'leri
+    std::vector<StaticProp> props;
+    SpatialGrid grid;
+    std::vector<int> visibleProps;
+    std::vector<unsigned char> batchVisible, listVisible;
 
-        walkingCompletionPercent += (1.0 / walkingTotalAnimationIteration);
-        if (walkingCompletionPercent >= 1.0)
-            walkingCompletionPercent -= 1.0;
+    void addProp(bool list, int index, Coordinates center, double radius)
+    {
+        StaticProp prop = {list, index};
+        grid.insert(props.size(), center, radius);
+        props.push_back(prop);
     }
 
-    void startRoaming(unsigned int a = 512)
+    static bool sameColor(const RGBA &a, const RGBA &b)
     {
-        roamingTotalAnimationIteration = a;
-        roaming = true;
+        return a.red == b.red && a.green == b.green && a.blue == b.blue && a.alpha == b.alpha;
     }
-    void stopRoaming(void)
+    int batchFor(RGBA color)
     {
-        roaming = false;
-        mainPosition.z = mainPosition.x = 0;
-        mainAngle.y = 0;
+        for (size_t i = 0; i < batches.size(); i++)
+            if (sameColor(batches[i].color, color))
+                return i;
+        StaticBatch batch;
+        batch.color = color;
+        batch.vertexBuffer = batch.indexBuffer = 0;
+        batch.uploaded = false;
+        batches.push_back(batch);
+        return batches.size() - 1;
     }
-    void toggleRoaming(void)
+    static void drawBatch(StaticBatch &batch)
     {
-        if (roaming)
-            stopRoaming();
+        if (!batch.uploaded)
+        {
+            if (!batch.vertexBuffer)
+            {
+                glGenBuffers(1, &batch.vertexBuffer);
+                glGenBuffers(1, &batch.indexBuffer);
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer);
+            glBufferData(GL_ARRAY_BUFFER, batch.mesh.vertices.size() * sizeof(GLfloat), &batch.mesh.vertices[0], GL_STATIC_DRAW);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.indexBuffer);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, batch.mesh.indices.size() * sizeof(GLuint), &batch.mesh.indices[0], GL_STATIC_DRAW);
+            batch.uploaded = true;
+        }
         else
-            startRoaming();
-    }
-    void roamingAnimation(void)
-    {
-        if (!roaming)
-            return;
-
-        // dolaşma animasyonu modelin zeminde tur atmasını sağlıyor
-        // x ve z ekseninin alacağı değerler aynı fonksiyonun t(zaman)
-        // ekseninde çeyrek periyot kaydırılmasıyla bulunuyor.
-
-        double framePositionZ = 3 * std::sin(roamingCompletionPercent * 360 * PI / 180);
-        mainPosition.z = framePositionZ;
-
-        double framePositionX = 3 * std::sin((roamingCompletionPercent + 0.25) * 360 * PI / 180);
-        mainPosition.x = framePositionX;
-
-        // Modelin önünün sürekli dönmesi gerekiyor. (Lineer zamanlamalı bir animasyon olduğu için sin/cos yok)
-        mainAngle.y = -roamingCompletionPercent * 360.0;
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.indexBuffer);
+        }
 
-        roamingCompletionPercent += (1.0 / roamingTotalAnimationIteration);
-        if (roamingCompletionPercent >= 1.0)
-            roamingCompletionPercent -= 1.0;
+        // Mesh::draw ile aynı düzen; işaretçiler tampon içindeki konumdur
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glVertexPointer(3, GL_FLOAT, 6 * sizeof(GLfloat), (const GLvoid *)0);
+        glNormalPointer(GL_FLOAT, 6 * sizeof(GLfloat), (const GLvoid *)(3 * sizeof(GLfloat)));
+        glDrawElements(GL_TRIANGLES, (GLsizei)batch.mesh.indices.size(), GL_UNSIGNED_INT, (const GLvoid *)0);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+
+        // Diğer istemci dizili çizimler bağlı tampon bulmamalı
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
-    void startWaving(unsigned int a = 48)
+public:
+    StaticScene(void)
     {
-        wavingTotalAnimationIteration = a;
-        waving = true;
+        grid.init(STATIC_GRID_CELL);
     }
-    void stopWaving(void)
+    ~StaticScene(void)
     {
-        waving = false;
+        clear();
     }
-    void toggleWaving(void)
+
+    void add(const Mesh &mesh, const Matrix4 &model, RGBA color)
     {
-        if (waving)
-            stopWaving();
-        else
-            startWaving();
+        // Mesh'in köşeleri dünya koordinatlarında, rengiyle aynı
+        // olan toplu mesh'in sonuna eklenir.
+        int index = batchFor(color);
+        StaticBatch &batch = batches[index];
+        const float *m = model.m;
+
+        // Normal matrisi: 3x3 kısmın ters devriği (kofaktörler / determinant)
+        double normalMatrix[9];
+        for (int row = 0; row < 3; row++)
+            for (int column = 0; column < 3; column++)
+            {
+                int r1 = (row + 1) % 3, r2 = (row + 2) % 3;
+                int c1 = (column + 1) % 3, c2 = (column + 2) % 3;
+                normalMatrix[column * 3 + row] = m[c1 * 4 + r1] * m[c2 * 4 + r2] - m[c2 * 4 + r1] * m[c1 * 4 + r2];
+            }
+        double determinant = m[0] * normalMatrix[0] + m[4] * normalMatrix[3] + m[8] * normalMatrix[6];
+        for (int i = 0; i < 9; i++)
+            normalMatrix[i] /= determinant;
+
+        // Cismin kapsama küresi dünya koordinatlarındaki kutusundan bulunur
+        double low[3] = {1e30, 1e30, 1e30}, high[3] = {-1e30, -1e30, -1e30};
+        GLuint base = batch.mesh.vertices.size() / 6;
+        for (size_t v = 0; v < mesh.vertices.size(); v += 6)
+        {
+            const GLfloat *p = &mesh.vertices[v];
+            for (int k = 0; k < 3; k++)
+            {
+                double position = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+                batch.mesh.vertices.push_back((GLfloat)position);
+                low[k] = std::min(low[k], position);
+                high[k] = std::max(high[k], position);
+            }
+            for (int k = 0; k < 3; k++)
+                batch.mesh.vertices.push_back((GLfloat)(normalMatrix[k] * p[3] + normalMatrix[3 + k] * p[4] + normalMatrix[6 + k] * p[5]));
+        }
+        for (size_t i = 0; i < mesh.indices.size(); i++)
+            batch.mesh.indices.push_back(base + mesh.indices[i]);
+        batch.uploaded = false;
+
+        if (mesh.vertices.empty())
+            return;
+        Coordinates center = {(low[0] + high[0]) / 2, (low[1] + high[1]) / 2, (low[2] + high[2]) / 2};
+        double dx = high[0] - center.x, dy = high[1] - center.y, dz = high[2] - center.z;
+        addProp(false, index, center, std::sqrt(dx * dx + dy * dy + dz * dz));
     }
-    void waveAnimation(void)
+    void addList(void (*draw)(void), const Matrix4 &model, RGBA color, double radius)
     {
-        if (!waving)
-            return;
-
-        // El sallama animasyonu ease-in-out zamanlamalı bir animasyon olması
-        // gerektiği için sin/cos fonksiyonu kullanılıyor. (cos'un tercih sebebi 1.00'dan başlaması)
+        // Üçgenleri bilinmeyen şekil, model matrisiyle birlikte bir
+        // display list'e derlenir. radius: modelin kendi uzayındaki
+        // kapsama küresi (ölçeksiz matris varsayılır)
+        StaticList item;
+        item.color = color;
+        item.list = glGenLists(1);
+        glNewList(item.list, GL_COMPILE);
+        glPushMatrix();
+        glMultMatrixf(model.m);
+        draw();
+        glPopMatrix();
+        glEndList();
+        lists.push_back(item);
 
-        double frameAngleZ = -20 * std::cos(wavingCompletionPercent * 360 * PI / 180);
+        Coordinates center = {model.m[12], model.m[13], model.m[14]};
+        addProp(true, lists.size() - 1, center, radius);
+    }
+    void clear(void)
+    {
+        for (size_t i = 0; i < batches.size(); i++)
+        {
+            GLuint buffers[] = {batches[i].vertexBuffer, batches[i].indexBuffer};
+            glDeleteBuffers(2, buffers);
+        }
+        batches.clear();
+        for (size_t i = 0; i < lists.size(); i++)
+            glDeleteLists(lists[i].list, 1);
+        lists.clear();
+        props.clear();
+        grid.clear();
+    }
 
-        // Ön kol ve arka kol frameAngleZ'nin farklı katsayılarla
-        // ölçeklendirilmesiyle elde edilen değerlerle eğiliyor.
-        setAngle(LEFT_ARM, Z, -frameAngleZ * 0.2 - 10);
-        setAngle(LEFT_FOREARM, Z, -frameAngleZ + 70);
+    void draw(const Frustum &frustum)
+    {
+        // Cisimlerinden biri görüş alanında olan her renk tek çağrıyla,
+        // kayıt sırasıyla çizilir
+        grid.queryFrustum(frustum, visibleProps);
+        batchVisible.assign(batches.size(), false);
+        listVisible.assign(lists.size(), false);
+        for (size_t i = 0; i < visibleProps.size(); i++)
+        {
+            const StaticProp &prop = props[visibleProps[i]];
+            (prop.list ? listVisible : batchVisible)[prop.index] = true;
+        }
 
-        // BONUS: Toggle the code below instead of above
-        // setAngle(LEFT_ARM, Z, -frameAngleZ * 1.5);
-        // setAngle(LEFT_FOREARM, Z, frameAngleZ * 2);
-        // setAngle(RIGHT_ARM, Z, -frameAngleZ * 1.5);
-        // setAngle(RIGHT_FOREARM, Z, frameAngleZ * 2);
+        for (size_t i = 0; i < batches.size(); i++)
+        {
+            StaticBatch &batch = batches[i];
+            if (!batchVisible[i] || batch.mesh.indices.empty())
+                continue;
+            glColor4d(batch.color.red, batch.color.green, batch.color.blue, batch.color.alpha);
+            drawBatch(batch);
+        }
+        for (size_t i = 0; i < lists.size(); i++)
+        {
+            const StaticList &item = lists[i];
+            if (!listVisible[i])
+                continue;
+            glColor4d(item.color.red, item.color.green, item.color.blue, item.color.alpha);
+            glCallList(item.list);
+        }
+    }
 
-        wavingCompletionPercent += (1.0 / wavingTotalAnimationIteration);
-        if (wavingCompletionPercent >= 1.0)
-            wavingCompletionPercent -= 1.0;
+    int drawCount(void) const
+    {
+        // Her karede yapılan en fazla çizim çağrısı sayısı
+        return batches.size() + lists.size();
     }
 };
 
 /////////////////////////////////////////////////////////////////// ANA SINIF
 
+// Komut satırından seçilen çalışma ayarları (bkz. parseOptions)
+
+typedef struct options
+{
+    int renderer;
+    int crowdSize;
+    bool crowdRoaming; // kalabalık yerlerinin çevresinde dolaşarak başlar
+    bool useSimd;
+    bool verifyKernel;
+    double startTime;
+    double targetFps; // 0: dikey eşitleme
+
+    // Seçeneklerin hepsi geçerli okunduysa true
+    bool valid;
+
+    // Pencere (veya penceresiz modda görüntü) boyutu
+    int width, height;
+
+    // Penceresiz çizim: kare sayısı, yazılacak dosyaların öneki
+    // (boşsa dosya yazılmaz) ve biçimi
+    bool headless;
+    int frames;
+    std::string outputPrefix;
+    int outputFormat;
+
+    // Model yürüyerek ve el sallayarak başlar
+    bool animate;
+
+    // Sabit sahnelerle aşama sürelerini ölç (bkz. runBenchmark)
+    bool benchmark;
+
+    // Profil özetini göster ve/veya her kareyi CSV dosyasına yaz
+    bool hud;
+    std::string profileCsv;
+
+    // Modellerin kurulacağı ikili iskelet dosyası ve --compile-rig
+    // ile metinden ikiliye çevrilecek dosyalar
+    std::string rigPath;
+    std::string rigSource, rigOutput;
+
+    // Anahtar kare klibi (bkz. AnimationClip)
+    std::string clipPath;
+
+    // Simülasyon aşamasının iş parçacığı sayısı (0: tüm çekirdekler)
+    int threads;
+
+    // Pencereli çizimde simülasyon ayrı iş parçacığında yürür
+    // (bkz. Simulation)
+    bool simThread;
+
+    // Yerleşik animasyon döngülerinin tablo çözünürlüğü (0: tablo yok)
+    int cycleSamples;
+
+    // Modeller parça parça değil, tek mesh ile çizilir (buffers gerektirir)
+    bool skinned;
+
+    // Kalabalıkta bu boydan (piksel) kısa görünen modeller impostor
+    // ile çizilir (0: kapalı)
+    double impostorHeight;
+
+    // Eklemleri oynamayan alt ağaçlar tek mesh'te birleştirilir
+    bool rigidMerge;
+
+    // Oturumun girdilerinin yazılacağı ve tekrar oynatılacak kayıt
+    // dosyaları (bkz. SessionLog)
+    std::string recordPath, replayPath;
+} Options;
+
+#define OUTPUT_PNG 0
+#define OUTPUT_RAW 1
+
+// Son karenin aşamalarına harcanan süreler (saniye)
+
+typedef struct frameTimings
+{
+    double animate, traverse, submit;
+} FrameTimings;
+
+// Animasyon karelerini zamanlayan GLUT zamanlayıcısı (bkz. GLHandler::timer)
+void frameTimer(int value);
+
 class GLHandler
 {
 private:
@@ -1133,16 +7123,115 @@ private:
     Camera camera;
     Human model1;
 
+    // Seçilen çizim yolu (RENDERER_LEGACY veya RENDERER_BUFFERS),
+    // tampon tabanlı çizici ve her karede doldurulan çizim listesi
+    int renderer;
+    BufferRenderer bufferRenderer;
+    std::vector<DrawItem> drawItems;
+    Matrix4 projection;
+
+    // Tek mesh'li çizimde model1'in kemik satırları
+    bool skinned;
+    std::vector<GLfloat> skinnedBones;
+
+    // Kalabalıkta uzak modellerin görüntüleri (--impostors)
+    ImpostorAtlas impostorAtlas;
+
+    // Kalabalık modunda model1 yerine çizilen modeller
+    Crowd crowd;
+
+    // Modellerin kurulduğu iskelet (varsayılan veya --rig ile verilen)
+    Rig rig;
+
+    // --clip ile yüklenen anahtar kare klibi (C ile oynatılır)
+    AnimationClip clip;
+
+    // Her karede kameradan hesaplanan görüş alanı
+    Frustum frustum;
+
+    // Kutular, demlik ve zemin (bkz. buildStaticModels)
+    StaticScene staticScene;
+
+    // Animasyonları ilerleten ve pozları yayımlayan simülasyon. Model
+    // ve kalabalık ona bağlı olduğu için onlardan sonra yok edilmelidir.
+    Simulation simulation;
+
+    // Animasyon sürerken iki kare arasındaki hedef süre (saniye,
+    // 0: dikey eşitleme), son karenin başladığı an ve bir sonraki
+    // kare için zamanlayıcının kurulu olup olmadığı
+    double frameInterval;
+    std::chrono::steady_clock::time_point frameStart;
+    bool frameScheduled;
+
+    // Penceresiz çizimde GLUT kullanılmaz; simülasyon her karede
+    // duvar saatinden bağımsız olarak frameInterval kadar ilerler.
+    bool headless;
+
+    FrameTimings timings;
+
+    // Profil özetinin ekranda gösterilip gösterilmediği
+    bool hudVisible;
+
+    // Oturum tekrarı: girdiler işleyicilere kayıttan veriliyorken
+    // dispatching açıktır (pencereden gelenler yok sayılır); ilk
+    // adımın duvar saatindeki ve kayıttaki anı
+    bool dispatching, replayStarted, replayReported;
+    std::chrono::steady_clock::time_point replayStart;
+    double replayOrigin;
+
 public:
-    void init(void)
+    bool init(Options options)
     {
+        // İstenen oturum kaydı açılamaz veya tekrar dosyası yüklenemezse
+        // false döner; çağıran program hata koduyla çıkmalıdır.
+
         // Kamera perspektif ayarı
 
         glMatrixMode(GL_PROJECTION);                   // Perspektif için
         glLoadIdentity();                              // Birim matris
-        gluPerspective(20, 1600.0 / 900.0, 0.1, 1000); // açı, oran, yakın, uzak
+        double aspect = (double)options.width / options.height;
+        gluPerspective(20, aspect, 0.1, 1000);         // açı, oran, yakın, uzak
         glMatrixMode(GL_MODELVIEW);                    // Sahne çizimi için
 
+        // Tampon tabanlı çizicinin kullanacağı aynı perspektif
+        projection = perspectiveMatrix(20, aspect, 0.1, 1000);
+
+        // Çizim yolunun seçimi. Shader'lar derlenemezse
+        // sabit fonksiyonlu hatta geri dönülür.
+        this->renderer = options.renderer;
+        if (renderer == RENDERER_BUFFERS && !bufferRenderer.init())
+        {
+            std::cerr << "tampon tabanlı çizici başlatılamadı, eski yol kullanılıyor" << std::endl;
+            this->renderer = RENDERER_LEGACY;
+        }
+
+        // İskelet dosyası verilmişse modeller ondan kurulur
+        if (!options.rigPath.empty())
+            rig.load(options.rigPath);
+
+        // Klip, kalabalık modunda tüm modellerin yürüyüşünün yerine geçer
+        if (!options.clipPath.empty() && clip.load(options.clipPath))
+        {
+            double maxError = 0;
+            for (int track = 0; track < clip.trackCount(); track++)
+                maxError = std::max(maxError, (double)clip.getTrack(track).maxError);
+            std::cerr << "klip: " << clip.trackCount() << " iz, " << clip.getLength() << " adım, "
+                      << clip.memoryUsage() << " bayt, en büyük hata " << maxError << " derece" << std::endl;
+        }
+
+        // Kalabalık modu örnekli çizim gerektirir
+        if (options.crowdSize > 0)
+        {
+            if (renderer == RENDERER_BUFFERS)
+            {
+                crowd.init(options.crowdSize, rig, &clip, options.useSimd);
+                if (options.crowdRoaming)
+                    crowd.startRoaming();
+            }
+            else
+                std::cerr << "kalabalık modu için --renderer=buffers gerekli" << std::endl;
+        }
+
         // Kameranın bakış açısında engelin
         // arkasında kalan cisimlerin çizilmemesi için
 
@@ -1163,116 +7252,471 @@ public:
         //           açıları ve ilgili parçaların birbirine kenetlenmesini
         //           sağlar, ayrıntılı açıklama Human sınıfının içindedir)
 
-        model1.init();
+        //          Animasyonlar simülasyondaki kopyada yürür, bu model
+        //          her karede onun pozunu alır.
+
+        model1.init(rig);
+
+        // Tek mesh'li çizim; desteklenmiyorsa parça parça çizime dönülür.
+        // (Tek mesh her parçanın kemiğini ayrı taşıdığı için sabit alt
+        // ağaçlar orada birleştirilmez.)
+        skinned = false;
+        if (options.skinned && renderer != RENDERER_BUFFERS)
+            std::cerr << "tek mesh'li çizim için --renderer=buffers gerekli" << std::endl;
+        else if (options.skinned && !bufferRenderer.initSkinning(model1.getSkeleton()))
+            std::cerr << "tek mesh'li çizim başlatılamadı, parçalar ayrı çiziliyor" << std::endl;
+        else if (options.skinned && crowd.size() > bufferRenderer.getSkinnedCapacity())
+            std::cerr << "kalabalığın kemikleri kemik dokusuna sığmıyor (en çok "
+                      << bufferRenderer.getSkinnedCapacity() << " model), parçalar ayrı çiziliyor" << std::endl;
+        else if (options.skinned)
+            skinned = true;
+        model1.setRigidMerging(options.rigidMerge && !skinned);
+        if (crowd.size() > 0)
+        {
+            crowd.setRigidMerging(options.rigidMerge && !skinned);
+            crowd.setSkinned(skinned);
+        }
+
+        // Uzak modellerin görüntüleri ışık ayarlarından sonra çizilir;
+        // yalnızca yürüyüp el sallayan kalabalıkta kullanılır.
+        if (options.impostorHeight > 0 && crowd.size() > 0)
+        {
+            if (!clip.isEmpty())
+                std::cerr << "impostorlar yalnızca yürüme ve el sallamayla kullanılabilir" << std::endl;
+            else if (!bufferRenderer.initImpostors() || !impostorAtlas.bake(rig, light.getPosition()))
+                std::cerr << "impostor dokusu hazırlanamadı" << std::endl;
+            else
+                crowd.setImpostors(&impostorAtlas, options.impostorHeight);
+        }
+
+        simulation.init(rig, &clip, crowd.size() > 0 ? &crowd : NULL, options.animate, options.startTime);
+
+        // Oturum kaydı ve tekrarı (tekrarda simülasyon kendi iş
+        // parçacığında yürümez, adımları replaySteps atar). Kayıtsız
+        // veya tekrarsız bir oturum istenmiş gibi sürdürülmez.
+        if (!options.recordPath.empty() && !simulation.record(options.recordPath, options.animate))
+            return false;
+        if (!options.replayPath.empty() && !simulation.startReplay(options.replayPath, options.animate))
+            return false;
+
+        // Profil ölçümleri HUD veya CSV istendiğinde açılır; yazılamayan
+        // bir profil dosyasıyla da oturum sürdürülmez.
+        hudVisible = options.hud;
+        if ((options.hud || !options.profileCsv.empty()) && !profiler.init(options.profileCsv))
+            return false;
+        dispatching = replayStarted = replayReported = false;
+        replayOrigin = 0;
+
+        // Dikey eşitleme açılamazsa kareler zamanlayıcıyla simülasyon
+        // hızında çizilir; yoksa her takastan hemen sonra yeni kare
+        // istemek işlemciyi boşuna meşgul ederdi.
+        headless = options.headless;
+        frameInterval = options.targetFps > 0 ? 1.0 / options.targetFps : 0;
+        if (frameInterval <= 0 && !headless && !requestSwapInterval())
+        {
+            std::cerr << "dikey eşitleme açılamadı, kareler saniyede " << SIMULATION_RATE << " kez çizilir" << std::endl;
+            frameInterval = 1.0 / SIMULATION_RATE;
+        }
+        frameScheduled = false;
+        simulation.start(frameInterval > 0 ? frameInterval : 1.0 / SIMULATION_RATE, headless,
+                         options.simThread && !headless && !simulation.isReplaying());
+
+        // Sabit modeller dünya koordinatlarında birleştirilir
+        buildStaticModels();
+        return true;
+    }
+    void display(void)
+    {
+        frameStart = std::chrono::steady_clock::now();
+        profiler.beginFrame();
+        profiler.begin("frame");
+
+        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+
+        // Kameranın güncel konumunu OpenGL'e bildirir
+        profiler.begin("camera");
+        camera.update();
+        frustum.set(projection * camera.viewMatrix());
+        profiler.end();
+
+        // Işığın güncel konumunu OpenGL'e bildirir
+        profiler.begin("light");
+        light.update();
+        profiler.end();
+
+        // Sahnedeki sabit modelleri çizer (yürümenin hissedilmesi için varlar)
+        std::chrono::steady_clock::time_point lap = std::chrono::steady_clock::now();
+        profiler.begin("drawStaticModels", true);
+        drawStaticModels();
+        profiler.end();
+        timings.submit = lapSeconds(lap);
+
+        // Ayrıntı seviyesi seçimi için 1 birim uzaklıktaki 1 birimlik
+        // cismin ekranda kaç piksel tuttuğu (perspektif açısı 20 derece)
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        double pixelScale = viewport[3] / 2.0 / std::tan(10 * PI / 180.0);
+        Coordinates eye = camera.getPosition();
+
+        // Simülasyonun en son pozu alınır. (Ayrı iş parçacığı yoksa
+        // adım burada atılır; pozlar son adım ile bir sonraki arasındaki
+        // ana göre hesaplanır.)
+        lap = std::chrono::steady_clock::now();
+        profiler.begin("animate");
+        if (simulation.isReplaying())
+            replaySteps();
+        FrameSnapshot &frame = simulation.update();
+        if (crowd.size() == 0)
+        {
+            model1.setJointAngles(&frame.joints[0]);
+            model1.setRootPose(frame.position, frame.angle);
+        }
+        profiler.end();
+        timings.animate = lapSeconds(lap);
+
+        // İskeleti güncel haliyle çizdirir.
+        if (crowd.size() > 0)
+        {
+            profiler.begin("traverse");
+            crowd.update(frame.crowd, frame.crowdPhases, frame.crowdMoves, eye, pixelScale, frustum);
+            profiler.end();
+            timings.traverse = lapSeconds(lap);
+            profiler.begin("drawInstanced", true);
+            if (skinned)
+                bufferRenderer.drawSkinned(crowd.bones, crowd.levelCounts, camera.viewMatrix(), projection, light.getPosition());
+            else
+                bufferRenderer.drawInstanced(crowd.batches, crowd.instances, camera.viewMatrix(), projection, light.getPosition());
+            profiler.end();
+            profiler.begin("drawImpostors", true);
+            bufferRenderer.drawImpostors(crowd.impostors, impostorAtlas, camera.viewMatrix(), projection);
+            profiler.end();
+        }
+        else if (skinned)
+        {
+            // Tüm model tek çizimdir; seviyesi gövdeninkidir.
+            profiler.begin("traverse");
+            Skeleton &skeleton = model1.getSkeleton();
+            model1.evaluate();
+            model1.selectLods(eye, pixelScale);
+            skinnedBones.resize(skeleton.size() * BONE_FLOATS);
+            for (int node = 0; node < skeleton.size(); node++)
+                skeleton.writeBoneRows(node, &skinnedBones[node * BONE_FLOATS]);
+            int levelCounts[LOD_LEVELS] = {0};
+            levelCounts[skeleton.getNode(0)->getLod()] = 1;
+            profiler.end();
+            timings.traverse = lapSeconds(lap);
+            profiler.begin("draw", true);
+            bufferRenderer.drawSkinned(skinnedBones, levelCounts, camera.viewMatrix(), projection, light.getPosition());
+            profiler.end();
+        }
+        else if (renderer == RENDERER_BUFFERS)
+        {
+            profiler.begin("traverse");
+            model1.evaluate();
+            model1.cull(frustum);
+            model1.selectLods(eye, pixelScale);
+            drawItems.clear();
+            model1.collect(drawItems);
+            profiler.end();
+            timings.traverse = lapSeconds(lap);
+            profiler.begin("draw", true);
+            bufferRenderer.draw(drawItems, camera.viewMatrix(), projection, light.getPosition());
+            profiler.end();
+        }
+        else
+        {
+            // Eski yolda iskelet OpenGL matris yığınıyla çizilir;
+            // seviyeler ve görünürlük aynı pozdan hesaplanır.
+            profiler.begin("traverse");
+            model1.evaluate();
+            model1.cull(frustum);
+            model1.selectLods(eye, pixelScale);
+            profiler.end();
+            timings.traverse = lapSeconds(lap);
+            profiler.begin("update");
+            model1.update();
+            profiler.end();
+        }
+        timings.submit += lapSeconds(lap);
+
+        profiler.end();
+        profiler.endFrame();
+
+        // Profil özeti sahnenin üstüne yazılır (GLUT fontu gerektirir)
+        if (hudVisible && !headless)
+            drawHud();
+
+        if (headless)
+            return;
+
+        glutSwapBuffers();
+
+        scheduleNextFrame();
+    }
+    bool isAnimating(void)
+    {
+        return simulation.isAnimating();
+    }
+    const FrameTimings &getTimings(void)
+    {
+        return timings;
+    }
+
+    void replaySteps(void)
+    {
+        // Kaydın sıradaki adımlarının girdileri kaydedildikleri
+        // işleyicilerden geçirilir, sonra adımları atılır. Penceresiz
+        // çizimde her karede bir adım (olabildiğince hızlı), pencerede
+        // kayıttaki zamanlamayla o ana kadar gelmiş tüm adımlar.
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!replayStarted && !simulation.isReplayFinished())
+        {
+            replayStarted = true;
+            replayStart = now;
+            replayOrigin = simulation.nextReplayStep().time;
+        }
+        double elapsed = std::chrono::duration<double>(now - replayStart).count();
+
+        while (!simulation.isReplayFinished())
+        {
+            const SessionStep &step = simulation.nextReplayStep();
+            if (!headless && step.time - replayOrigin > elapsed)
+                break;
+            dispatching = true;
+            for (int i = 0; i < step.inputCount; i++)
+            {
+                const InputEvent &event = simulation.getReplayInput(step.firstInput + i);
+                if (event.type == INPUT_KEY)
+                    keyboard(event.code, 0, 0);
+                else if (event.type == INPUT_MOUSE)
+                    mouse(event.code, GLUT_DOWN, 0, 0);
+                else if (event.type == INPUT_PICK)
+                    simulation.post(INPUT_PICK, event.code); // ışın kayıttakiyle aynı olmayabilir
+                else
+                    specialKeyboard(event.code, 0, 0);
+            }
+            dispatching = false;
+            simulation.replayStep();
+            if (headless)
+                break;
+        }
+
+        // Penceresiz çizimde sonuç runHeadless'ta yazılır. Pencerede
+        // tekrar bitince oturum canlı sürer.
+        if (!headless && simulation.isReplayFinished() && !replayReported)
+        {
+            replayReported = true;
+            std::cerr << "tekrar bitti: " << simulation.getReplayLength() << " adım, "
+                      << simulation.getReplayMismatches() << " adımda poz kayıttakinden farklı" << std::endl;
+            simulation.endReplay();
+        }
+    }
+    bool isReplaying(void)
+    {
+        return simulation.isReplaying();
     }
-    void display(void)
+    int getReplayLength(void)
     {
-        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+        return simulation.getReplayLength();
+    }
+    int getReplayMismatches(void)
+    {
+        return simulation.getReplayMismatches();
+    }
+    void drawHud(void)
+    {
+        // Son tamamlanan karenin kapsamları, iç içe olanlar girintili
+        const ProfileFrame &frame = profiler.getLatest();
+        if (frame.number < 0)
+            return;
 
-        // Kameranın güncel konumunu OpenGL'e bildirir
-        camera.update();
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
 
-        // Işığın güncel konumunu OpenGL'e bildirir
-        light.update();
+        // Piksel koordinatlı, ışıksız ve derinlik testsiz çizim
+        glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+        glDisable(GL_LIGHTING);
+        glDisable(GL_DEPTH_TEST);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(0, viewport[2], 0, viewport[3], -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
 
-        // Sahnedeki sabit modelleri çizer (yürümenin hissedilmesi için varlar)
-        drawStaticModels();
+        glColor3d(1, 1, 1);
+        std::vector<std::string> lines;
+        lines.push_back("kapsam                   cpu ms   gpu ms  cagri");
+        for (size_t i = 0; i < frame.scopes.size(); i++)
+        {
+            const ProfileScope &scope = frame.scopes[i];
+            std::string name = std::string(scope.depth * 2, ' ') + scope.name;
+            char line[128];
+            if (scope.gpuSeconds >= 0)
+                snprintf(line, sizeof(line), "%-22.22s %8.3f %8.3f %6d", name.c_str(), scope.cpuSeconds * 1000.0, scope.gpuSeconds * 1000.0, scope.calls);
+            else
+                snprintf(line, sizeof(line), "%-22.22s %8.3f %8s %6d", name.c_str(), scope.cpuSeconds * 1000.0, "-", scope.calls);
+            lines.push_back(line);
+        }
+        for (size_t i = 0; i < lines.size(); i++)
+        {
+            glRasterPos2i(10, viewport[3] - 20 - 15 * i);
+            for (size_t c = 0; c < lines[i].size(); c++)
+                glutBitmapCharacter(GLUT_BITMAP_9_BY_15, lines[i][c]);
+        }
 
-        // İskeleti güncel haliyle çizdirir. (animasyonları bu sınıf üstleniyor)
-        model1.update();
+        glPopMatrix();
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glPopAttrib();
+    }
+    void scheduleNextFrame(void)
+    {
+        // Sahne değişmeyecekse yeni kare istenmez; GLUT bir sonraki
+        // girdiye kadar uykuda bekler.
+        if (!isAnimating() || frameScheduled)
+            return;
 
-        glutSwapBuffers();
+        // Dikey eşitlemede bekleme glutSwapBuffers içinde olur.
+        if (frameInterval <= 0)
+        {
+            glutPostRedisplay();
+            return;
+        }
+
+        // Aksi halde bir sonraki kare, bu karenin başlangıcından
+        // frameInterval sonra çizilir.
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count();
+        int delay = (int)std::max(0.0, (frameInterval - elapsed) * 1000.0);
+        frameScheduled = true;
+        glutTimerFunc(delay, frameTimer, 0);
     }
-    void drawStaticModels(void)
+    void timer(void)
+    {
+        frameScheduled = false;
+        glutPostRedisplay();
+    }
+    static bool requestSwapInterval(void)
+    {
+        // Geçerli bağlamda takasların dikey eşitlemeyi beklemesini ister;
+        // sürücü bunu desteklemiyorsa false döner.
+#if defined(__APPLE__)
+        GLint interval = 1;
+        return CGLSetParameter(CGLGetCurrentContext(), kCGLCPSwapInterval, &interval) == kCGLNoError;
+#elif defined(__linux__)
+        typedef void (*SwapIntervalEXT)(Display *, GLXDrawable, int);
+        typedef int (*SwapInterval)(unsigned int);
+        Display *display = glXGetCurrentDisplay();
+        GLXDrawable drawable = glXGetCurrentDrawable();
+        if (!display || !drawable)
+            return false;
+        const char *extensions = glXQueryExtensionsString(display, DefaultScreen(display));
+        if (!extensions)
+            return false;
+        std::string available = std::string(" ") + extensions + " ";
+        if (available.find(" GLX_EXT_swap_control ") != std::string::npos)
+        {
+            SwapIntervalEXT swapInterval = (SwapIntervalEXT)glXGetProcAddressARB((const GLubyte *)"glXSwapIntervalEXT");
+            if (swapInterval)
+            {
+                swapInterval(display, drawable, 1);
+                return true;
+            }
+        }
+        const char *names[] = {"GLX_MESA_swap_control", "glXSwapIntervalMESA", "GLX_SGI_swap_control", "glXSwapIntervalSGI"};
+        for (int i = 0; i < 4; i += 2)
+        {
+            if (available.find(std::string(" ") + names[i] + " ") == std::string::npos)
+                continue;
+            SwapInterval swapInterval = (SwapInterval)glXGetProcAddressARB((const GLubyte *)names[i + 1]);
+            if (swapInterval && swapInterval(1) == 0)
+                return true;
+        }
+        return false;
+#else
+        return false;
+#endif
+    }
+    static void drawTeapot(void)
+    {
+        glutSolidTeapot(0.3);
+    }
+    // Demlik GLUT penceresi gerektirdiği için penceresiz çizimde (ve
+    // kıyaslamada) sahnede yoktur; çıktılar bunu belirtir.
+    static bool drawsTeapot(bool headless)
+    {
+        return !headless;
+    }
+    void buildStaticModels(void)
     {
+        // Sabit modeller bir kez kaydedilir (bkz. StaticScene). Kutular
+        // glutSolidCube ile aynı olan önbellekteki mesh'lerdir; demlik
+        // yalnızca pencereli çizimde vardır (bkz. drawsTeapot).
+        RGBA purple = {1.0, 0.6, 1.0, 1.0};
+        RGBA blue = {0.6, 1.0, 1.0, 1.0};
+        RGBA brown = {0.5, 0.2, 0, 1.0};
+        RGBA white = {1, 1, 1, 1.0};
+
         // mor kutu
-        glPushMatrix();
-        glColor3d(1.0, 0.6, 1.0);
-        glTranslated(-1.0, 0.15, -1.0);
-        glRotated(60, 0, 1, 0);
-        glutSolidCube(0.3);
-        glPopMatrix();
+        staticScene.add(*meshCache.get(RECTANGULARPRISM, 0.3, 0.3, 0.3, 0, 0),
+                        translationMatrix(-1.0, 0.15, -1.0) * rotationMatrix(60, 1), purple);
         // mavi kutu
-        glPushMatrix();
-        glColor3d(0.6, 1.0, 1.0);
-        glTranslated(1.0, 0.35, 1.0);
-        glRotated(30, 0, 1, 0);
-        glutSolidCube(0.7);
-        glPopMatrix();
+        staticScene.add(*meshCache.get(RECTANGULARPRISM, 0.7, 0.7, 0.7, 0, 0),
+                        translationMatrix(1.0, 0.35, 1.0) * rotationMatrix(30, 1), blue);
         // demlik
-        glPushMatrix();
-        glColor3d(0.5, 0.2, 0);
-        glTranslated(1.0, 0.95, 1.0);
-        glutSolidTeapot(0.3);
-        glPopMatrix();
+        if (drawsTeapot(headless))
+            staticScene.addList(drawTeapot, translationMatrix(1.0, 0.95, 1.0), brown, 0.5);
         // zemin
-        glPushMatrix();
-        glColor3d(1, 1, 1);
-        glScaled(10.0, 0.05, 10.0);
-        glutSolidCube(1.0);
-        glPopMatrix();
+        staticScene.add(*meshCache.get(RECTANGULARPRISM, 1.0, 1.0, 1.0, 0, 0), scaleMatrix(10.0, 0.05, 10.0), white);
+    }
+    void drawStaticModels(void)
+    {
+        // Renk başına tek çizim; görüş alanı dışındakiler atlanır
+        staticScene.draw(frustum);
+    }
+    bool acceptsInput(void)
+    {
+        // Tekrar sırasında yalnızca kayıttan gelen girdiler işlenir
+        return !simulation.isReplaying() || dispatching;
     }
     void keyboard(unsigned char key, int x, int y)
     {
         // Ekstra olan klavye kısayolları
         // Gerekli olanlar bir alttaki metotta
+        if (!acceptsInput())
+            return;
+
+        // Eklem açıları ve konum değiştiği için sahne yeniden çizilir.
+        if (!headless)
+            glutPostRedisplay();
 
         switch (key)
         {
-
-        case 'q':
-            model1.raiseAngle(LEFT_FOREARM, Z, -1);
-            break;
-        case 'Q':
-            model1.raiseAngle(LEFT_FOREARM, Z, 1);
-            break;
-        case 'w':
-            model1.raiseAngle(LEFT_ARM, Z, -1);
-            break;
-        case 'W':
-            model1.raiseAngle(LEFT_ARM, Z, 1);
-            break;
-
-        case 't':
-            model1.raiseAngle(RIGHT_FOREARM, Z, 1);
-            break;
-        case 'T':
-            model1.raiseAngle(RIGHT_FOREARM, Z, -1);
-            break;
-        case 'r':
-            model1.raiseAngle(RIGHT_ARM, Z, 1);
-            break;
-        case 'R':
-            model1.raiseAngle(RIGHT_ARM, Z, -1);
-            break;
-
-        case 'e':
-        case 'E':
-            model1.raiseMainCoordinates(0, 0, 0.1);
-            break;
-        case 'd':
-        case 'D':
-            model1.raiseMainCoordinates(0, 0, -0.1);
-            break;
-        case 's':
-        case 'S':
-            model1.raiseMainCoordinates(0.1, 0, 0);
-            break;
-        case 'f':
-        case 'F':
-            model1.raiseMainCoordinates(-0.1, 0, 0);
-            break;
-
-        case 'a':
-            model1.raiseAngle(RIGHT_FOOT, X, -1);
-            break;
-        case 'A':
-            model1.raiseAngle(RIGHT_FOOT, X, 1);
+        case 'h':
+        case 'H':
+            // Profil özetini aç/kapat
+            if (!profiler.isEnabled())
+                profiler.init("");
+            hudVisible = !hudVisible;
             break;
         }
+
+        // Tüm tuşlar simülasyona gönderilir: model tuşları (q/w/t/r,
+        // e/s/d/f, a, c) orada uygulanır, hepsi oturum kaydına yazılır
+        // (bkz. Simulation::applyInput)
+        simulation.post(INPUT_KEY, key);
     }
     void specialKeyboard(int key, int x, int y)
     {
+        if (!acceptsInput())
+            return;
+
+        // Kamera hareket ettiği için sahne yeniden çizilir.
+        if (!headless)
+            glutPostRedisplay();
+
         switch (key)
         {
         case GLUT_KEY_LEFT:
@@ -1288,50 +7732,700 @@ public:
             camera.translateY(-0.5); // dikey kamera hareketi
             break;
         }
+
+        // Yalnızca oturum kaydı için
+        simulation.post(INPUT_SPECIAL, key);
     }
     void mouse(int button, int state, int x, int y)
     {
+        if (!acceptsInput())
+            return;
         if (state == GLUT_DOWN)
         { // farenin basılma anı
-            switch (button)
+            // Sol tık el sallamayı, sağ tık yürümeyi açar/kapatır
+            // (bkz. Simulation::applyInput). Kalabalıkta sol tık imlecin
+            // altındaki modeli seçer; kayda seçilen model yazılır.
+            if (crowd.size() > 0 && button == GLUT_LEFT_BUTTON)
             {
-            case GLUT_LEFT_BUTTON:
-                model1.toggleWaving(); // wave
-                break;
-            case GLUT_RIGHT_BUTTON:
-                model1.toggleWalking(); // walk
-                break;
+                int actor = pickActor(x, y);
+                if (actor >= 0)
+                    simulation.post(INPUT_PICK, actor);
             }
+            else
+                simulation.post(INPUT_MOUSE, button);
+            if (!headless)
+                glutPostRedisplay();
         }
     }
-    void idle(void)
+    int pickActor(int x, int y)
     {
-        // input cihazlarından veriler alındığında sadece
-        // nesnelerin bilgileri güncellenir. Yeniden çizme
-        // işlemi frekans sabitlemesi açısından sadece idle
-        // tarafından sağlanır.
-        glutPostRedisplay();
+        // Pencere noktasından kameranın yakın ve uzak düzlemlerine
+        // uzanan ışın, kalabalığın ızgarasında izlenir
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        Matrix4 view = camera.viewMatrix();
+        GLdouble modelView[16], projectionMatrix[16];
+        for (int i = 0; i < 16; i++)
+        {
+            modelView[i] = view.m[i];
+            projectionMatrix[i] = projection.m[i];
+        }
+        GLdouble nearPoint[3], farPoint[3];
+        GLdouble windowY = viewport[3] - y;
+        if (!gluUnProject(x, windowY, 0, modelView, projectionMatrix, viewport, &nearPoint[0], &nearPoint[1], &nearPoint[2]) ||
+            !gluUnProject(x, windowY, 1, modelView, projectionMatrix, viewport, &farPoint[0], &farPoint[1], &farPoint[2]))
+            return -1;
+        Coordinates origin = {nearPoint[0], nearPoint[1], nearPoint[2]};
+        Coordinates direction = {farPoint[0] - nearPoint[0], farPoint[1] - nearPoint[1], farPoint[2] - nearPoint[2]};
+        double length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        return crowd.pick(origin, direction, length);
+    }
+};
+
+/////////////////////////////////////////////////////////////////// PENCERESİZ ÇİZİM
+
+/*
+Ekranı olmayan makinelerde (--headless) aynı init/display hattı, EGL
+ile pencere yüzeyi olmadan açılan bir bağlamda bir framebuffer
+nesnesine (FBO) çizilir. Kareler ham RGBA veya PNG olarak yazılabilir.
+
+PNG için dış kütüphane kullanılmaz: görüntü sıkıştırılmadan, zlib
+akışının "stored" bloklarıyla yazılır.
+*/
+
+static unsigned int crc32(unsigned int crc, const unsigned char *data, size_t length)
+{
+    static unsigned int table[256];
+    static bool tableReady = false;
+    if (!tableReady)
+    {
+        for (unsigned int n = 0; n < 256; n++)
+        {
+            unsigned int c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+    crc ^= 0xffffffffu;
+    for (size_t i = 0; i < length; i++)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffu;
+}
+
+static void pushBigEndian(std::vector<unsigned char> &out, unsigned int value)
+{
+    out.push_back((value >> 24) & 0xff);
+    out.push_back((value >> 16) & 0xff);
+    out.push_back((value >> 8) & 0xff);
+    out.push_back(value & 0xff);
+}
+
+static void pushPngChunk(std::vector<unsigned char> &out, const char *type, const std::vector<unsigned char> &data)
+{
+    // uzunluk, tür, veri, türün ve verinin CRC'si
+    pushBigEndian(out, data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    pushBigEndian(out, crc32(0, &out[start], out.size() - start));
+}
+
+bool writePng(const std::string &path, int width, int height, const std::vector<unsigned char> &rgba)
+{
+    // Her satırın başına filtre türü (0: yok) eklenir
+    std::vector<unsigned char> scanlines;
+    scanlines.reserve((size_t)(width * 4 + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rgba.begin() + (size_t)y * width * 4, rgba.begin() + (size_t)(y + 1) * width * 4);
+    }
+
+    // zlib başlığı, en fazla 65535 baytlık sıkıştırılmamış bloklar
+    // ve Adler-32 sağlaması
+    std::vector<unsigned char> stream;
+    stream.push_back(0x78);
+    stream.push_back(0x01);
+    unsigned int a = 1, b = 0;
+    for (size_t offset = 0; offset < scanlines.size(); offset += 65535)
+    {
+        unsigned int length = std::min(scanlines.size() - offset, (size_t)65535);
+        stream.push_back(offset + length == scanlines.size() ? 1 : 0);
+        stream.push_back(length & 0xff);
+        stream.push_back(length >> 8);
+        stream.push_back(~length & 0xff);
+        stream.push_back((~length >> 8) & 0xff);
+        stream.insert(stream.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+        for (size_t i = offset; i < offset + length; i++)
+        {
+            a = (a + scanlines[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    pushBigEndian(stream, (b << 16) | a);
+
+    // 8 bit RGBA, sıkıştırma/filtre/aralama varsayılan
+    std::vector<unsigned char> header;
+    pushBigEndian(header, width);
+    pushBigEndian(header, height);
+    header.push_back(8);
+    header.push_back(6);
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    std::vector<unsigned char> png(signature, signature + 8);
+    pushPngChunk(png, "IHDR", header);
+    pushPngChunk(png, "IDAT", stream);
+    pushPngChunk(png, "IEND", std::vector<unsigned char>());
+
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write((const char *)&png[0], png.size());
+    return file.good();
+}
+
+class HeadlessContext
+{
+    // Pencere yerine EGL bağlamı ve pencerenin arka tamponu yerine
+    // renk ve derinlik tamponlu bir FBO
+private:
+#ifdef HEADLESS_EGL
+    EGLDisplay display;
+    EGLContext context;
+    GLuint framebuffer, renderbuffers[2];
+#endif
+    bool ready;
+
+public:
+    HeadlessContext(void)
+    {
+        ready = false;
+    }
+    bool create(int width, int height)
+    {
+#ifdef HEADLESS_EGL
+        // Mesa'nın yüzeysiz platformu varsa pencere sistemine hiç
+        // bağlanılmaz, yoksa varsayılan ekran denenir.
+        display = EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+#endif
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+        {
+            std::cerr << "EGL başlatılamadı" << std::endl;
+            return false;
+        }
+
+        const EGLint attributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+        EGLConfig config;
+        EGLint configCount = 0;
+        context = EGL_NO_CONTEXT;
+        if (eglBindAPI(EGL_OPENGL_API) && eglChooseConfig(display, attributes, &config, 1, &configCount) && configCount > 0)
+            context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+        if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+        {
+            std::cerr << "EGL ile OpenGL bağlamı oluşturulamadı" << std::endl;
+            eglTerminate(display);
+            return false;
+        }
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glGenRenderbuffers(2, renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+
+        ready = true;
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "framebuffer oluşturulamadı" << std::endl;
+            destroy();
+            return false;
+        }
+        glViewport(0, 0, width, height);
+        return true;
+#else
+        std::cerr << "penceresiz çizim bu platformda desteklenmiyor (EGL gerekli)" << std::endl;
+        return false;
+#endif
+    }
+    void destroy(void)
+    {
+        if (!ready)
+            return;
+#ifdef HEADLESS_EGL
+        glDeleteRenderbuffers(2, renderbuffers);
+        glDeleteFramebuffers(1, &framebuffer);
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+#endif
+        ready = false;
     }
 };
 
+int runHeadless(GLHandler &handler, Options options)
+{
+    HeadlessContext context;
+    if (!context.create(options.width, options.height))
+        return 1;
+    if (!handler.init(options))
+    {
+        context.destroy();
+        return 1;
+    }
+
+    // Tekrarda her kare kaydın bir adımıdır
+    if (handler.isReplaying())
+        options.frames = handler.getReplayLength();
+
+    // Kare hızı yalnızca çizimi kapsar, dosya yazma süresi dışarıda kalır.
+    int result = 0;
+    std::vector<unsigned char> pixels((size_t)options.width * options.height * 4);
+    std::vector<unsigned char> image(pixels.size());
+    double renderSeconds = 0;
+    for (int frame = 0; frame < options.frames; frame++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        handler.display();
+        glFinish();
+        renderSeconds += lapSeconds(start);
+
+        if (options.outputPrefix.empty())
+            continue;
+
+        // OpenGL satırları alttan üste verir, dosyalar üstten alta yazılır.
+        glReadPixels(0, 0, options.width, options.height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        size_t rowBytes = (size_t)options.width * 4;
+        for (int y = 0; y < options.height; y++)
+            memcpy(&image[y * rowBytes], &pixels[(options.height - 1 - y) * rowBytes], rowBytes);
+
+        char number[16];
+        snprintf(number, sizeof(number), "%04d", frame);
+        std::string path = options.outputPrefix + number;
+        bool written;
+        if (options.outputFormat == OUTPUT_RAW)
+        {
+            std::ofstream file((path + ".rgba").c_str(), std::ios::binary);
+            file.write((const char *)&image[0], image.size());
+            written = file.good();
+        }
+        else
+            written = writePng(path + ".png", options.width, options.height, image);
+        if (!written)
+        {
+            std::cerr << "kare yazılamadı: " << path << std::endl;
+            result = 1;
+            break;
+        }
+    }
+
+    std::cout << options.frames << " kare, " << renderSeconds << " sn, "
+              << (renderSeconds > 0 ? options.frames / renderSeconds : 0) << " kare/sn" << std::endl;
+    if (!GLHandler::drawsTeapot(true))
+        std::cout << "not: demlik penceresiz çizimde yok, sahne pencereli çizimden farklı" << std::endl;
+    profiler.flush();
+
+    // Tekrarın pozları kayıttakinden farklıysa hata döner
+    if (handler.isReplaying())
+    {
+        int mismatches = handler.getReplayMismatches();
+        std::cout << "tekrar: " << options.frames << " adım, " << mismatches << " adımda poz kayıttakinden farklı" << std::endl;
+        if (mismatches > 0 && result == 0)
+            result = 2;
+    }
+
+    context.destroy();
+    return result;
+}
+
+/////////////////////////////////////////////////////////////////// KIYASLAMA (BENCHMARK)
+
+/*
+--benchmark, sabit sahneleri pencere ve girdi olmadan, penceresiz
+bağlamda sırayla çizer ve her aşamanın kare başına süresinin
+yüzdeliklerini (p50/p95/p99, milisaniye) JSON olarak yazar.
+
+Aşamalar (bkz. FrameTimings):
+    animate  : animasyonların pozu belirlemesi
+    traverse : iskelet hesabı, görüş alanı testi, LOD seçimi
+    submit   : çizim komutlarının verilmesi (eski yolda Object::update)
+    display  : GLHandler::display ve glFinish, yani karenin tamamı
+
+Simülasyon saati penceresiz modda olduğu gibi her karede sabit adım
+ilerler; aynı seçeneklerle her çalıştırma aynı kareleri çizer.
+*/
+
+#define BENCHMARK_WARMUP_FRAMES 5
+
+typedef struct benchmarkScene
+{
+    const char *name;
+    int crowdSize;
+    bool animate;
+    bool roaming; // kalabalık dolaşır, ızgaradaki kayıtlar her adımda güncellenir
+} BenchmarkScene;
+
+static const BenchmarkScene benchmarkScenes[] = {
+    {"idle", 0, false, false},
+    {"walk-wave", 0, true, false},
+    {"crowd-100", 100, true, false},
+    {"crowd-1000", 1000, true, false},
+    {"crowd-roaming-1000", 1000, true, true},
+    {"crowd-10000", 10000, true, false}};
+
+double percentile(std::vector<double> samples, double p)
+{
+    // En yakın sıra yöntemi
+    if (samples.empty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    int rank = (int)std::ceil(p / 100.0 * samples.size()) - 1;
+    return samples[std::min(std::max(rank, 0), (int)samples.size() - 1)];
+}
+
+void writePercentiles(std::ostream &out, const char *name, const std::vector<double> &samples)
+{
+    out << "\"" << name << "\": {\"p50\": " << percentile(samples, 50) * 1000.0
+        << ", \"p95\": " << percentile(samples, 95) * 1000.0
+        << ", \"p99\": " << percentile(samples, 99) * 1000.0 << "}";
+}
+
+int runBenchmark(Options options)
+{
+    HeadlessContext context;
+    if (!context.create(options.width, options.height))
+        return 1;
+
+    std::ostream &out = std::cout;
+    out << "{\"frames\": " << options.frames
+        << ", \"width\": " << options.width << ", \"height\": " << options.height
+        << ", \"renderer\": \"" << (options.renderer == RENDERER_BUFFERS ? "buffers" : "legacy") << "\""
+        << ", \"threads\": " << workers.size()
+        << ", \"skinned\": " << (options.skinned ? "true" : "false")
+        << ", \"impostorHeight\": " << options.impostorHeight
+        << ", \"rigidMerge\": " << (options.rigidMerge ? "true" : "false")
+        << ", \"teapot\": " << (GLHandler::drawsTeapot(true) ? "true" : "false")
+        << ", \"unit\": \"ms\", \"scenes\": [";
+
+    int sceneCount = sizeof(benchmarkScenes) / sizeof(benchmarkScenes[0]);
+    for (int i = 0; i < sceneCount; i++)
+    {
+        const BenchmarkScene &scene = benchmarkScenes[i];
+        Options sceneOptions = options;
+        sceneOptions.headless = true;
+        sceneOptions.crowdSize = scene.crowdSize;
+        sceneOptions.crowdRoaming = scene.roaming;
+        sceneOptions.animate = scene.animate;
+        sceneOptions.recordPath.clear();
+        sceneOptions.replayPath.clear();
+        if (scene.crowdSize > 0)
+            sceneOptions.renderer = RENDERER_BUFFERS;
+
+        // Kalabalıklar büyük olduğu için her sahne kendi nesnesinde
+        GLHandler *handler = new GLHandler();
+        if (!handler->init(sceneOptions))
+        {
+            delete handler;
+            return 1;
+        }
+
+        std::vector<double> animate, traverse, submit, display;
+        for (int frame = -BENCHMARK_WARMUP_FRAMES; frame < options.frames; frame++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            handler->display();
+            glFinish();
+            double total = lapSeconds(start);
+            if (frame < 0)
+                continue;
+
+            const FrameTimings &timings = handler->getTimings();
+            animate.push_back(timings.animate);
+            traverse.push_back(timings.traverse);
+            submit.push_back(timings.submit);
+            display.push_back(total);
+        }
+        delete handler;
+
+        out << (i > 0 ? ", " : "") << "{\"name\": \"" << scene.name << "\", \"actors\": "
+            << std::max(scene.crowdSize, 1) << ", ";
+        writePercentiles(out, "animate", animate);
+        out << ", ";
+        writePercentiles(out, "traverse", traverse);
+        out << ", ";
+        writePercentiles(out, "submit", submit);
+        out << ", ";
+        writePercentiles(out, "display", display);
+        out << "}";
+    }
+    out << "]}" << std::endl;
+
+    context.destroy();
+    return 0;
+}
+
 /////////////////////////////////////////////////////////////////// MAİN
 
 // OpenGL callbacklerini ve bu callback'lerin ihtiyaç duyacağı
 // tüm değişkenleri bu nesne barındıracak.
 GLHandler gl;
 
+void frameTimer(int /*value*/)
+{
+    gl.timer();
+}
+
+Options parseOptions(int argc, char **argv)
+{
+    // Komut satırı seçenekleri
+    //    --renderer=legacy  : sabit fonksiyonlu çizim (varsayılan)
+    //    --renderer=buffers : VBO/VAO ve shader ile çizim
+    //    --crowd=N          : N modelli kalabalık, örnekli çizim (buffers gerektirir)
+    //    --crowd-roam       : kalabalıktaki modeller yerlerinin çevresinde dolaşarak başlar
+    //    --no-simd          : kalabalığın iskeletlerini skaler döngüyle hesapla
+    //    --verify-kernel    : SIMD iskelet çekirdeğini skaler hesapla karşılaştır
+    //    --start-time=S     : simülasyonu S. saniyeden başlat
+    //    --fps=N            : animasyon sürerken saniyedeki kare hedefi (varsayılan 60)
+    //    --fps=vsync        : kareleri dikey eşitlemeye göre çiz
+    //    --size=WxH         : pencere/görüntü boyutu (varsayılan 1600x900)
+    //    --headless         : pencere açmadan çiz (EGL), kare hızını yazdır
+    //    --frames=N         : penceresiz modda çizilecek kare sayısı (varsayılan 60)
+    //    --output=ÖNEK      : penceresiz modda kareleri ÖNEK0000.png ... olarak yaz
+    //    --format=png|raw   : kare dosyalarının biçimi (raw: üstten alta RGBA8)
+    //    --animate          : model yürüyerek ve el sallayarak başlar
+    //    --benchmark        : sabit sahnelerin aşama sürelerini JSON olarak yazdır
+    //    --hud              : profil özetini sahnenin üstünde göster (H ile aç/kapat)
+    //    --profile-csv=DOSYA: her karenin profil ölçümlerini CSV olarak yaz
+    //    --rig=DOSYA        : modelleri ikili iskelet dosyasından kur
+    //    --compile-rig=KAYNAK,ÇIKTI : metin iskeleti ikili dosyaya çevir
+    //    --clip=DOSYA       : anahtar kare klibini yükle (C ile oynat, kalabalıkta hep oynar)
+    //    --threads=N        : animasyon ve iskelet hesabı için iş parçacığı sayısı (varsayılan: çekirdek sayısı)
+    //    --no-sim-thread    : simülasyonu ayrı iş parçacığı yerine her karede çizimden önce yürüt
+    //    --cycle-samples=N  : yürüme/el sallama/dolaşma döngülerinin tablo örnek sayısı (varsayılan 256, 0: her karede hesapla)
+    //    --skinned          : her modeli tek mesh ile, kemik matrisleri vertex shader'da uygulanarak çiz (buffers gerektirir)
+    //    --impostors[=N]    : kalabalıkta ekranda N pikselden (varsayılan 32) kısa görünen modelleri önceden çizilmiş görüntüleriyle çiz
+    //    --rigid-merge      : eklemleri oynamayan parçaları (baş, gözler, ...) sabit grup başına tek mesh'te birleştir
+    //    --record=DOSYA     : oturumun girdilerini ve simülasyon adımlarını ikili dosyaya yaz
+    //    --replay=DOSYA     : kaydı aynı işleyicilerle tekrar oynat (pencerede kayıttaki hızda, --headless ile olabildiğince hızlı)
+    Options options;
+    options.renderer = RENDERER_LEGACY;
+    options.crowdSize = 0;
+    options.crowdRoaming = false;
+    options.useSimd = true;
+    options.verifyKernel = false;
+    options.startTime = 0;
+    options.targetFps = 60;
+    options.valid = true;
+    options.width = 1600;
+    options.height = 900;
+    options.headless = false;
+    options.frames = 60;
+    options.outputFormat = OUTPUT_PNG;
+    options.animate = false;
+    options.benchmark = false;
+    options.hud = false;
+    options.threads = 0;
+    options.simThread = true;
+    options.cycleSamples = CYCLE_SAMPLES;
+    options.skinned = false;
+    options.impostorHeight = 0;
+    options.rigidMerge = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--renderer=buffers")
+            options.renderer = RENDERER_BUFFERS;
+        else if (argument == "--renderer=legacy")
+            options.renderer = RENDERER_LEGACY;
+        else if (argument.compare(0, 8, "--crowd=") == 0)
+            options.crowdSize = atoi(argument.c_str() + 8);
+        else if (argument == "--crowd-roam")
+            options.crowdRoaming = true;
+        else if (argument == "--no-simd")
+            options.useSimd = false;
+        else if (argument == "--verify-kernel")
+            options.verifyKernel = true;
+        else if (argument.compare(0, 13, "--start-time=") == 0)
+            options.startTime = atof(argument.c_str() + 13);
+        else if (argument == "--fps=vsync")
+            options.targetFps = 0;
+        else if (argument.compare(0, 6, "--fps=") == 0)
+        {
+            // Kare hedefi pozitif bir sayı veya vsync olmalı
+            char *end;
+            options.targetFps = strtod(argument.c_str() + 6, &end);
+            if (end == argument.c_str() + 6 || *end != '\0' || !(options.targetFps > 0) || !std::isfinite(options.targetFps))
+            {
+                std::cerr << "geçersiz kare hedefi: " << argument << " (pozitif bir sayı veya vsync olmalı)" << std::endl;
+                options.valid = false;
+            }
+        }
+        else if (argument.compare(0, 7, "--size=") == 0)
+        {
+            const char *separator = strchr(argument.c_str(), 'x');
+            if (separator)
+            {
+                options.width = std::max(atoi(argument.c_str() + 7), 1);
+                options.height = std::max(atoi(separator + 1), 1);
+            }
+        }
+        else if (argument == "--headless")
+            options.headless = true;
+        else if (argument.compare(0, 9, "--frames=") == 0)
+            options.frames = atoi(argument.c_str() + 9);
+        else if (argument.compare(0, 9, "--output=") == 0)
+            options.outputPrefix = argument.substr(9);
+        else if (argument == "--format=raw")
+            options.outputFormat = OUTPUT_RAW;
+        else if (argument == "--format=png")
+            options.outputFormat = OUTPUT_PNG;
+        else if (argument == "--animate")
+            options.animate = true;
+        else if (argument == "--benchmark")
+            options.benchmark = true;
+        else if (argument == "--hud")
+            options.hud = true;
+        else if (argument.compare(0, 14, "--profile-csv=") == 0)
+            options.profileCsv = argument.substr(14);
+        else if (argument.compare(0, 6, "--rig=") == 0)
+            options.rigPath = argument.substr(6);
+        else if (argument.compare(0, 14, "--compile-rig=") == 0)
+        {
+            std::string paths = argument.substr(14);
+            std::string::size_type comma = paths.find(',');
+            options.rigSource = paths.substr(0, comma);
+            options.rigOutput = comma == std::string::npos ? paths + "b" : paths.substr(comma + 1);
+        }
+        else if (argument.compare(0, 7, "--clip=") == 0)
+            options.clipPath = argument.substr(7);
+        else if (argument.compare(0, 10, "--threads=") == 0)
+            options.threads = std::max(atoi(argument.c_str() + 10), 0);
+        else if (argument == "--no-sim-thread")
+            options.simThread = false;
+        else if (argument.compare(0, 16, "--cycle-samples=") == 0)
+            options.cycleSamples = std::max(atoi(argument.c_str() + 16), 0);
+        else if (argument == "--skinned")
+            options.skinned = true;
+        else if (argument == "--impostors")
+            options.impostorHeight = IMPOSTOR_HEIGHT;
+        else if (argument.compare(0, 12, "--impostors=") == 0)
+            options.impostorHeight = std::max(atof(argument.c_str() + 12), 0.0);
+        else if (argument == "--rigid-merge")
+            options.rigidMerge = true;
+        else if (argument.compare(0, 9, "--record=") == 0)
+            options.recordPath = argument.substr(9);
+        else if (argument.compare(0, 9, "--replay=") == 0)
+            options.replayPath = argument.substr(9);
+    }
+    return options;
+}
+
+int verifySkeletonKernel(void)
+{
+    // SkeletonBatch'in SIMD çekirdeğini, aynı rastgele pozlar için
+    // skaler döngünün ve tek modelli Skeleton::evaluate'in sonucuyla
+    // karşılaştırır. Fark toleranstan büyükse 1 döner.
+    const int rigs = 37;
+    const double tolerance = 1e-4;
+
+    Human human;
+    human.init();
+    Skeleton &skeleton = human.getSkeleton();
+
+    SkeletonBatch simd, scalar;
+    simd.build(skeleton, rigs);
+    scalar.build(skeleton, rigs);
+
+    srand(2016);
+    for (int rig = 0; rig < rigs; rig++)
+    {
+        Matrix4 root = translationMatrix(rand() % 200 / 10.0 - 10, 0, rand() % 200 / 10.0 - 10) *
+                       rotationMatrix(rand() % 360, Y);
+        simd.setRoot(rig, root);
+        scalar.setRoot(rig, root);
+        for (int node = 0; node < skeleton.size(); node++)
+        {
+            Angles angles = {rand() % 14400 / 10.0 - 720, rand() % 14400 / 10.0 - 720, rand() % 14400 / 10.0 - 720};
+            simd.setJointAngles(rig, node, angles);
+            scalar.setJointAngles(rig, node, angles);
+        }
+    }
+    simd.evaluate();
+    scalar.evaluateScalar();
+
+    double maximumError = 0;
+    for (int rig = 0; rig < rigs; rig++)
+        for (int node = 0; node < skeleton.size(); node++)
+        {
+            Matrix4 a = simd.getMeshMatrix(rig, node), b = scalar.getMeshMatrix(rig, node);
+            for (int k = 0; k < 16; k++)
+                maximumError = std::max(maximumError, (double)std::fabs(a.m[k] - b.m[k]));
+        }
+
+    // Başlangıç pozundaki model, çizicinin kullandığı yolla da hesaplanır
+    SkeletonBatch single;
+    single.build(skeleton, 1);
+    single.setRoot(0, human.getRootMatrix());
+    single.copyPose(0, skeleton);
+    single.evaluate();
+    human.evaluate();
+    for (int node = 0; node < skeleton.size(); node++)
+    {
+        Matrix4 a = single.getMeshMatrix(0, node), b = skeleton.getMeshMatrix(node);
+        for (int k = 0; k < 16; k++)
+            maximumError = std::max(maximumError, (double)std::fabs(a.m[k] - b.m[k]));
+    }
+
+    std::cout << "iskelet çekirdeği: en büyük fark " << maximumError
+              << (maximumError <= tolerance ? " (geçti)" : " (KALDI)") << std::endl;
+    return maximumError <= tolerance ? 0 : 1;
+}
+
 int main(int argc, char **argv)
 {
+    Options options = parseOptions(argc, argv);
+    if (!options.valid)
+        return 1;
+    workers.init(options.threads);
+    Human::bakeCycles(options.cycleSamples);
+    if (options.verifyKernel)
+        return verifySkeletonKernel();
+    if (!options.rigSource.empty())
+        return compileRig(options.rigSource, options.rigOutput) ? 0 : 1;
+    if (options.benchmark)
+        return runBenchmark(options);
+    if (options.headless)
+        return runHeadless(gl, options);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_RGB | GLUT_DEPTH | GLUT_DOUBLE);
 
     glutInitWindowPosition(0, 0);
-    glutInitWindowSize(1600, 900);
+    glutInitWindowSize(options.width, options.height);
     glutCreateWindow("github.com/ufukty - 2016");
 
+#ifdef _MSC_VER
+    glewInit();
+#endif
+
     // Perspektif ayarı, depth ayarı, Camera::init çağrısı,
     // Light::init çağrısı ve Human::init çağrısı yapılıyor.
-    gl.init();
+    if (!gl.init(options))
+        return 1;
 
     // GLHandler içindeki ilgili callback fonksiyonları çağıran
     // isimsiz(lambda) fonksiyonların OpenGL'e bildirilmesi. (C++11)
@@ -1339,7 +8433,9 @@ int main(int argc, char **argv)
     glutKeyboardFunc([](unsigned char key, int x, int y) -> void { gl.keyboard(key, x, y); });
     glutSpecialFunc([](int key, int x, int y) -> void { gl.specialKeyboard(key, x, y); });
     glutMouseFunc([](int button, int state, int x, int y) -> void { gl.mouse(button, state, x, y); });
-    glutIdleFunc([](void) -> void { gl.idle(); });
+
+    // Idle callback'i yok: kareler yalnızca girdiyle veya animasyon
+    // sürerken scheduleNextFrame ile istenir.
 
     glutMainLoop();
     return 0;